@@ -0,0 +1,191 @@
+#include "AssetLoader.h"
+#include "GLResources.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace
+{
+	std::mutex mainThreadMutex;
+	std::deque<std::coroutine_handle<>> mainThreadQueue;
+
+	struct ObjData
+	{
+		std::vector<GLfloat> positions, textureCoords, normals;
+		std::vector<glm::vec3> vertices;
+		std::string materialFile;
+	};
+
+	bool parseOBJ(const std::string& path, ObjData& obj)
+	{
+		std::vector<glm::vec2> textures;
+		std::vector<glm::vec3> normals;
+
+		std::ifstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to open file: " << path << std::endl;
+			return false;
+		}
+
+		//ndice "v/vt/vn" de um vrtice de face
+		auto readIndices = [](const std::string& vertex, int& v, int& t, int& n)
+			{
+				std::istringstream(vertex.substr(0, vertex.find('/'))) >> v;
+				std::istringstream(vertex.substr(vertex.find('/') + 1, vertex.rfind('/') - vertex.find('/') - 1)) >> t;
+				std::istringstream(vertex.substr(vertex.rfind('/') + 1)) >> n;
+			};
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream iss(line);
+			std::string prefix;
+			iss >> prefix;
+
+			if (prefix == "mtllib")
+			{
+				iss >> obj.materialFile;
+			}
+			else if (prefix == "v")
+			{
+				float x, y, z;
+				iss >> x >> y >> z;
+				obj.vertices.push_back(glm::vec3(x, y, z));
+			}
+			else if (prefix == "vt")
+			{
+				float u, v;
+				iss >> u >> v;
+				textures.push_back(glm::vec2(u, v));
+			}
+			else if (prefix == "vn")
+			{
+				float x, y, z;
+				iss >> x >> y >> z;
+				normals.push_back(glm::vec3(x, y, z));
+			}
+			else if (prefix == "f")
+			{
+				std::string corners[3];
+				iss >> corners[0] >> corners[1] >> corners[2];
+
+				for (int i = 0; i < 3; i++)
+				{
+					int v = 0, t = 0, n = 0;
+					readIndices(corners[i], v, t, n);
+					const glm::vec3& vertex = obj.vertices[v - 1];
+					const glm::vec2& texture = textures[t - 1];
+					const glm::vec3& normal = normals[n - 1];
+
+					obj.positions.insert(obj.positions.end(), { vertex.x, vertex.y, vertex.z });
+					obj.textureCoords.insert(obj.textureCoords.end(), { texture.x, texture.y });
+					obj.normals.insert(obj.normals.end(), { normal.x, normal.y, normal.z });
+				}
+			}
+		}
+		return true;
+	}
+
+	MaterialAsset parseMTL(const std::string& path)
+	{
+		MaterialAsset material = { glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, "" };
+		std::ifstream file(path);
+		std::string line, readValue;
+		while (std::getline(file, line))
+		{
+			std::istringstream iss(line);
+			if (line.find("map_Kd") == 0)
+				iss >> readValue >> material.texturePath;
+			else if (line.find("Ka") == 0)
+				iss >> readValue >> material.ka.x >> material.ka.y >> material.ka.z;
+			else if (line.find("Ks") == 0)
+				iss >> readValue >> material.ks.x >> material.ks.y >> material.ks.z;
+			else if (line.find("Ns") == 0)
+				iss >> readValue >> material.ns;
+		}
+		return material;
+	}
+}
+
+namespace Assets
+{
+	void MainThreadAwaiter::await_suspend(std::coroutine_handle<> handle) const
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		mainThreadQueue.push_back(handle);
+	}
+
+	int pump(double budget)
+	{
+		double start = glfwGetTime();
+		int resumed = 0;
+		do
+		{
+			std::coroutine_handle<> handle;
+			{
+				std::lock_guard<std::mutex> lock(mainThreadMutex);
+				if (mainThreadQueue.empty())
+					break;
+				handle = mainThreadQueue.front();
+				mainThreadQueue.pop_front();
+			}
+			handle.resume();
+			resumed++;
+		} while (glfwGetTime() - start < budget);
+		return resumed;
+	}
+
+	int getPendingUploads()
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		return (int)mainThreadQueue.size();
+	}
+
+	Task<MeshAsset> loadMesh(std::string path, GeometryArena* arena)
+	{
+		co_await resumeInBackground();
+		MeshAsset mesh = {};
+		mesh.geometry = -1;
+		ObjData obj;
+		if (!parseOBJ(path, obj))
+			co_return mesh;
+		buildIndexedMesh(obj.positions, obj.textureCoords, obj.normals, mesh.vertices, mesh.indices);
+		computeBounds(obj.vertices, mesh.box, mesh.sphere);
+		mesh.positions = std::move(obj.positions);
+		mesh.materialFile = obj.materialFile;
+
+		co_await resumeOnMainThread();
+		mesh.geometry = arena->allocate(mesh.vertices.data(), (GLuint)mesh.vertices.size(), mesh.indices.data(), (GLuint)mesh.indices.size());
+		co_return mesh;
+	}
+
+	Task<MaterialAsset> loadMaterial(std::string path)
+	{
+		co_await resumeInBackground();
+		co_return parseMTL(path);
+	}
+
+	Task<TextureAsset> loadTexture(std::string path)
+	{
+		co_await resumeInBackground();
+		int width = 0, height = 0, channels = 0;
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		if (!data)
+			std::cout << "Failed to load texture" << std::endl;
+
+		co_await resumeOnMainThread();
+		TextureAsset texture = { createTexture2D(width, height, channels, data), width, height };
+		stbi_image_free(data);
+		co_return texture;
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <coroutine>
+#include <string>
+#include <thread>
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "GeometryArena.h"
+#include "JobSystem.h"
+#include "Task.h"
+
+struct MeshAsset
+{
+	int geometry;                    //Alocao na arena (-1 se o arquivo no abriu)
+	std::vector<MeshVertex> vertices;
+	std::vector<GLuint> indices;
+	std::vector<GLfloat> positions;  //Tringulos soltos (x, y, z por vrtice), como vieram do OBJ
+	BoundingBox box;                 //Limites no espao do modelo
+	BoundingSphere sphere;
+	std::string materialFile;        //mtllib do OBJ
+};
+
+struct MaterialAsset
+{
+	glm::vec3 ka, ks;
+	float ns;
+	std::string texturePath;         //map_Kd
+};
+
+struct TextureAsset
+{
+	GLuint id;
+	int width, height;
+};
+
+// Carregamento de assets com corrotinas: a leitura e a decodificao rodam em
+// jobs do JobSystem e o envio para a OpenGL roda na thread principal, quando ela
+// chama pump(). Quem carrega escreve s o encadeamento, sem callbacks:
+//     MeshAsset mesh = co_await Assets::loadMesh(path, &arena);
+//     TextureAsset texture = co_await Assets::loadTexture(path);
+// Vrias tarefas comeadas juntas se sobrepem sozinhas: cada uma ocupa um job
+// enquanto l e s entra na fila da thread principal para o envio.
+namespace Assets
+{
+	//co_await resumeInBackground(): o resto da corrotina roda em um job
+	struct BackgroundAwaiter
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const { jobSystem.run([handle]() { handle.resume(); }); }
+		void await_resume() const noexcept {}
+	};
+
+	//co_await resumeOnMainThread(): o resto da corrotina roda no prximo pump()
+	struct MainThreadAwaiter
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const;
+		void await_resume() const noexcept {}
+	};
+
+	inline BackgroundAwaiter resumeInBackground() { return {}; }
+	inline MainThreadAwaiter resumeOnMainThread() { return {}; }
+
+	//S a thread da OpenGL chama. Retoma as corrotinas na fila at esvaziar ou passar
+	//de budget segundos (ao menos uma); retorna quantas retomou
+	int pump(double budget);
+	//Corrotinas esperando a thread principal
+	int getPendingUploads();
+
+	//Comea e espera uma tarefa sem parar a fila: s para o carregamento inicial
+	template<typename T>
+	T wait(Task<T>& task)
+	{
+		task.start();
+		while (!task.isDone())
+			if (pump(0.0) == 0 && !jobSystem.help())
+				std::this_thread::yield();
+		return task.result();
+	}
+
+	//Arquivos lidos nos jobs; a malha e a textura terminam na thread principal
+	Task<MeshAsset> loadMesh(std::string path, GeometryArena* arena);
+	Task<MaterialAsset> loadMaterial(std::string path);
+	Task<TextureAsset> loadTexture(std::string path);
+}
@@ -40,33 +40,6 @@ void Bezier::generateCurve(int pointsPerSegment)
 		}
 	}
 
-	//Gera o VAO
-	GLuint VBO;
-
-	//Gerao do identificador do VBO
-	glGenBuffers(1, &VBO);
-
-	//Faz a conexo (vincula) do buffer como um buffer de array
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-	//Envia os dados do array de floats para o buffer da OpenGl
-	glBufferData(GL_ARRAY_BUFFER, curvePoints.size() * sizeof(GLfloat) * 3, curvePoints.data(), GL_STATIC_DRAW);
-
-	//Gerao do identificador do VAO (Vertex Array Object)
-	glGenVertexArrays(1, &VAO);
-
-	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vrtices
-	// e os ponteiros para os atributos 
-	glBindVertexArray(VAO);
-
-	//Atributo posio (x, y, z)
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-	glEnableVertexAttribArray(0);
-
-	// Observe que isso  permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vrtice 
-	// atualmente vinculado - para que depois possamos desvincular com segurana
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	// Desvincula o VAO ( uma boa prtica desvincular qualquer buffer ou array para evitar bugs medonhos)
-	glBindVertexArray(0);
+	//Envia os pontos para a GPU e (re)cria o VAO
+	uploadCurve();
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+void computeBounds(const std::vector<glm::vec3>& points, BoundingBox& box, BoundingSphere& sphere)
+{
+	if (points.empty())
+	{
+		box = BoundingBox{ glm::vec3(0.0f), glm::vec3(0.0f) };
+		sphere = BoundingSphere{ glm::vec3(0.0f), 0.0f };
+		return;
+	}
+
+	box.min = box.max = points[0];
+	for (const glm::vec3& p : points)
+	{
+		box.min = glm::min(box.min, p);
+		box.max = glm::max(box.max, p);
+	}
+
+	sphere.center = (box.min + box.max) * 0.5f;
+	float radius2 = 0.0f;
+	for (const glm::vec3& p : points)
+	{
+		glm::vec3 d = p - sphere.center;
+		radius2 = std::max(radius2, glm::dot(d, d));
+	}
+	sphere.radius = std::sqrt(radius2);
+}
+
+BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& model)
+{
+	float scale2 = std::max(glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+		std::max(glm::dot(glm::vec3(model[1]), glm::vec3(model[1])), glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))));
+	return BoundingSphere{ glm::vec3(model * glm::vec4(sphere.center, 1.0f)), sphere.radius * std::sqrt(scale2) };
+}
+
+BoundingBox transformBox(const BoundingBox& box, const glm::mat4& model)
+{
+	//Arvo: cada coluna da matriz contribui com o menor/maior produto em cada eixo
+	BoundingBox result{ glm::vec3(model[3]), glm::vec3(model[3]) };
+	for (int c = 0; c < 3; c++)
+	{
+		glm::vec3 a = glm::vec3(model[c]) * box.min[c];
+		glm::vec3 b = glm::vec3(model[c]) * box.max[c];
+		result.min += glm::min(a, b);
+		result.max += glm::max(a, b);
+	}
+	return result;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+struct BoundingBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+//Caixa e esfera que envolvem os pontos (esfera centrada na caixa, raio at o ponto mais distante)
+void computeBounds(const std::vector<glm::vec3>& points, BoundingBox& box, BoundingSphere& sphere);
+
+//Esfera/caixa em coordenadas de mundo; a escala no uniforme aumenta o raio pela maior escala
+BoundingSphere transformSphere(const BoundingSphere& sphere, const glm::mat4& model);
+BoundingBox transformBox(const BoundingBox& box, const glm::mat4& model);
@@ -1,4 +1,5 @@
 #include "Camera.h"
+#include "HelloShader.h"
 
 void Camera::initialize(Shader* shader, int width, int height, float sensitivity, float pitch, float yaw, glm::vec3 cameraFront, glm::vec3 cameraPos, glm::vec3 cameraUp)
 {
@@ -13,14 +14,16 @@ void Camera::initialize(Shader* shader, int width, int height, float sensitivity
 	this->cameraFront = cameraFront;
 	this->cameraPos = cameraPos;
 	this->cameraUp = cameraUp;
+	nearPlane = 0.1f;
+	farPlane = 100.0f;
 
 	//Matriz de view -- posio e orientao da cmera
 	glm::mat4 view = glm::lookAt(glm::vec3(0.0, 0.0, 3.0), glm::vec3(0.0, 0.0, 0.0), glm::vec3(0.0, 1.0, 0.0));
-	shader->setMat4("view", value_ptr(view));
+	shader->set(HelloShader::view, view);
 
 	//Matriz de projeo perspectiva - definindo o volume de visualizao (frustum)
-	glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
-	shader->setMat4("projection", glm::value_ptr(projection));
+	projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, nearPlane, farPlane);
+	shader->set(HelloShader::projection, projection);
 }
 
 void Camera::rotate(GLFWwindow* window, double xpos, double ypos)
@@ -52,12 +55,14 @@ void Camera::rotate(GLFWwindow* window, double xpos, double ypos)
 }
 
 void Camera::update() {
+	//Os compute shaders do quadro podem ter deixado outro programa em uso
+	shader->Use();
+
 	//Atualizando a posio e orientao da cmera
-	glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-	shader->setMat4("view", glm::value_ptr(view));
+	shader->set(HelloShader::view, getViewMatrix());
 
 	//Atualizando o shader com a posio da cmera
-	shader->setVec3("cameraPos", cameraPos.x, cameraPos.y, cameraPos.z);
+	shader->set(HelloShader::cameraPos, cameraPos);
 }
 
 void Camera::move(GLFWwindow* window, int key, int action)
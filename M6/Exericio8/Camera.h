@@ -18,11 +18,20 @@ public:
 	void rotate(GLFWwindow* window, double xpos, double ypos);
 	void update();
 
+	glm::mat4 getViewMatrix() const { return glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp); }
+	glm::mat4 getProjectionMatrix() const { return projection; }
+	glm::vec3 getPosition() const { return cameraPos; }
+	glm::vec3 getFront() const { return cameraFront; }
+	float getNearPlane() const { return nearPlane; }
+	float getFarPlane() const { return farPlane; }
+
 protected:
 	Shader* shader;
 	bool firstMouse, rotateX, rotateY, rotateZ;
 	float lastX, lastY, pitch, yaw;
 	float sensitivity;
+	float nearPlane, farPlane;
+	glm::mat4 projection;
 	glm::vec3 cameraFront, cameraPos, cameraUp;
 };
 #pragma once
@@ -0,0 +1,87 @@
+#include "ClusteredLighting.h"
+#include "ClusteredLightingShaders.h"
+#include "HelloShader.h"
+
+#include <algorithm>
+
+void ClusteredLighting::initialize(Shader* clusterShader, int maxLights)
+{
+	this->clusterShader = clusterShader;
+	this->maxLights = maxLights;
+	lightCount = 0;
+
+	lightBuffer.initialize((GLsizeiptr)std::max(maxLights, 1) * sizeof(PointLight), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	countBuffer.initialize((GLsizeiptr)CLUSTER_COUNT * sizeof(GLuint), nullptr);
+	indexBuffer.initialize((GLsizeiptr)CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER * sizeof(GLuint), nullptr);
+}
+
+void ClusteredLighting::destroy()
+{
+	lightBuffer.destroy();
+	countBuffer.destroy();
+	indexBuffer.destroy();
+	lightCount = 0;
+}
+
+void ClusteredLighting::setLights(const std::vector<PointLight>& lights)
+{
+	lightCount = (int)std::min(lights.size(), (size_t)maxLights);
+	if (lightCount > 0)
+		lightBuffer.update(0, lightCount * sizeof(PointLight), lights.data());
+}
+
+void ClusteredLighting::update(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane)
+{
+	this->nearPlane = nearPlane;
+	this->farPlane = farPlane;
+
+	clusterShader->Use();
+	clusterShader->set(LightClusterShader::lightCount, lightCount);
+	clusterShader->set(LightClusterShader::view, view);
+	clusterShader->set(LightClusterShader::inverseProjection, glm::inverse(projection));
+	clusterShader->set(LightClusterShader::clusterGrid, glm::ivec3(TILES_X, TILES_Y, SLICES));
+	clusterShader->set(LightClusterShader::clusterDepthRange, glm::vec2(nearPlane, farPlane));
+	clusterShader->set(LightClusterShader::maxLightsPerCluster, MAX_LIGHTS_PER_CLUSTER);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightClusterShader::LIGHTS_BINDING, lightBuffer.ID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightClusterShader::COUNTS_BINDING, countBuffer.ID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightClusterShader::INDICES_BINDING, indexBuffer.ID);
+	//A barreira antes do hello.fs ler as listas (SSBO) fica com o RenderGraph
+	glDispatchCompute((CLUSTER_COUNT + LightClusterShader::WORKGROUP_SIZE - 1) / LightClusterShader::WORKGROUP_SIZE, 1, 1);
+}
+
+void ClusteredLighting::bind(Shader* drawShader, int width, int height) const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightClusterShader::LIGHTS_BINDING, lightBuffer.ID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightClusterShader::COUNTS_BINDING, countBuffer.ID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LightClusterShader::INDICES_BINDING, indexBuffer.ID);
+
+	drawShader->Use();
+	drawShader->set(HelloShader::clusteredLights, lightCount > 0);
+	drawShader->set(HelloShader::clusterGrid, glm::ivec3(TILES_X, TILES_Y, SLICES));
+	drawShader->set(HelloShader::clusterScreenSize, glm::vec2((float)width, (float)height));
+	drawShader->set(HelloShader::clusterDepthRange, glm::vec2(nearPlane, farPlane));
+	drawShader->set(HelloShader::maxLightsPerCluster, MAX_LIGHTS_PER_CLUSTER);
+}
+
+ClusterStats ClusteredLighting::readStats() const
+{
+	std::vector<GLuint> counts(CLUSTER_COUNT);
+	glGetNamedBufferSubData(countBuffer.ID, 0, CLUSTER_COUNT * sizeof(GLuint), counts.data());
+
+	ClusterStats stats = { 0, 0, 0, 0.0f };
+	unsigned long long total = 0;
+	for (GLuint count : counts)
+	{
+		if (count == 0)
+			continue;
+		stats.clusters++;
+		stats.maxPerCluster = std::max(stats.maxPerCluster, (unsigned int)count);
+		if (count >= (GLuint)MAX_LIGHTS_PER_CLUSTER)
+			stats.saturated++;
+		total += count;
+	}
+	if (stats.clusters > 0)
+		stats.averagePerCluster = (float)total / stats.clusters;
+	return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "GLResources.h"
+
+// Luz pontual no layout std430 lido pelo light_cluster.comp e pelo hello.fs
+struct PointLight
+{
+	glm::vec4 positionRadius; //posio no mundo (xyz) e alcance (w)
+	glm::vec4 color;          //cor j multiplicada pela intensidade (rgb)
+};
+
+struct ClusterStats
+{
+	unsigned int clusters;        //Clusters com pelo menos uma luz
+	unsigned int maxPerCluster;   //Maior lista de luzes de um cluster
+	unsigned int saturated;       //Clusters que atingiram MAX_LIGHTS_PER_CLUSTER
+	float averagePerCluster;      //Mdia de luzes nos clusters ocupados
+};
+
+// Forward clusterizado: o volume de viso  dividido em TILES_X x TILES_Y tiles
+// de tela e SLICES fatias de profundidade (exponenciais), e o light_cluster.comp
+// monta, para cada cluster, a lista das luzes cujo alcance toca a caixa dele.
+// O hello.fs s percorre a lista do seu cluster, ento o custo por fragmento
+// depende das luzes prximas e no do total da cena.
+class ClusteredLighting
+{
+public:
+	static const int TILES_X = 16;
+	static const int TILES_Y = 16;
+	static const int SLICES = 24;
+	static const int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+	static const int MAX_LIGHTS_PER_CLUSTER = 128;
+
+	ClusteredLighting() : clusterShader(nullptr), maxLights(0), lightCount(0), nearPlane(0.1f), farPlane(100.0f) {}
+
+	void initialize(Shader* clusterShader, int maxLights);
+	void destroy();
+
+	void setLights(const std::vector<PointLight>& lights);
+	int getLightCount() const { return lightCount; }
+	//Buffer com as listas por cluster (as contagens andam junto)
+	GLuint getClusterBuffer() const { return indexBuffer.ID; }
+
+	//Remonta as listas para a cmera do quadro (chamar antes de desenhar)
+	void update(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane);
+	//Liga os buffers e passa a grade ao programa de desenho (o programa fica em uso)
+	void bind(Shader* drawShader, int width, int height) const;
+
+	//L as contagens da GPU (espera a GPU terminar: s para estatsticas)
+	ClusterStats readStats() const;
+
+protected:
+	Shader* clusterShader;
+	int maxLights, lightCount;
+	float nearPlane, farPlane;
+
+	Buffer lightBuffer;   //PointLight por luz
+	Buffer countBuffer;   //uint por cluster
+	Buffer indexBuffer;   //MAX_LIGHTS_PER_CLUSTER ndices por cluster
+};
@@ -0,0 +1,27 @@
+// Interface esperada do compute shader light_cluster.comp, conferida logo
+// depois do link (mesmo esquema do HelloShader.h)
+
+#pragma once
+
+#include "UniformReflection.h"
+
+namespace LightClusterShader
+{
+	constexpr UniformDecl<int> lightCount("lightCount");
+	constexpr UniformDecl<glm::mat4> view("view");
+	constexpr UniformDecl<glm::mat4> inverseProjection("inverseProjection");
+	constexpr UniformDecl<glm::ivec3> clusterGrid("clusterGrid");
+	constexpr UniformDecl<glm::vec2> clusterDepthRange("clusterDepthRange");
+	constexpr UniformDecl<int> maxLightsPerCluster("maxLightsPerCluster");
+
+	//Os mesmos bindings so lidos pelo hello.fs
+	constexpr GLuint LIGHTS_BINDING = 5;
+	constexpr GLuint COUNTS_BINDING = 6;
+	constexpr GLuint INDICES_BINDING = 7;
+	constexpr GLuint WORKGROUP_SIZE = 64;
+
+	constexpr UniformSignature uniforms[] = {
+		lightCount, view, inverseProjection,
+		clusterGrid, clusterDepthRange, maxLightsPerCluster
+	};
+}
@@ -0,0 +1,80 @@
+#include "CommandList.h"
+#include "GLState.h"
+
+void CommandList::clear()
+{
+	commands.clear();
+	program = vao = 0xFFFFFFFFu;
+	for (int u = 0; u < MAX_UNITS; u++)
+		textures[u] = 0xFFFFFFFFu;
+}
+
+void CommandList::useProgram(GLuint program)
+{
+	if (this->program == program)
+		return;
+	this->program = program;
+	commands.push_back(RenderCommand{ CommandType::UseProgram, program, 0, 0, 0, 0, 0 });
+}
+
+void CommandList::bindTexture(GLuint unit, GLuint texture)
+{
+	if (unit < MAX_UNITS)
+	{
+		if (textures[unit] == texture)
+			return;
+		textures[unit] = texture;
+	}
+	commands.push_back(RenderCommand{ CommandType::BindTexture, texture, unit, 0, 0, 0, 0 });
+}
+
+void CommandList::bindVertexArray(GLuint vao)
+{
+	if (this->vao == vao)
+		return;
+	this->vao = vao;
+	commands.push_back(RenderCommand{ CommandType::BindVertexArray, vao, 0, 0, 0, 0, 0 });
+}
+
+void CommandList::bindUniformRange(GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	commands.push_back(RenderCommand{ CommandType::BindUniformRange, buffer, binding, offset, size, 0, 0 });
+}
+
+void CommandList::drawElements(GLsizei count, GLuint firstIndex, GLint baseVertex)
+{
+	commands.push_back(RenderCommand{ CommandType::DrawElements, 0, 0, (GLintptr)firstIndex * (GLintptr)sizeof(GLuint), 0, count, baseVertex });
+}
+
+void CommandList::drawArrays(GLint first, GLsizei count)
+{
+	commands.push_back(RenderCommand{ CommandType::DrawArrays, 0, 0, 0, 0, count, first });
+}
+
+void CommandList::replay() const
+{
+	for (const RenderCommand& c : commands)
+	{
+		switch (c.type)
+		{
+		case CommandType::UseProgram:
+			glState.useProgram(c.object);
+			break;
+		case CommandType::BindTexture:
+			glState.bindTexture(c.slot, GL_TEXTURE_2D, c.object);
+			break;
+		case CommandType::BindVertexArray:
+			glState.bindVertexArray(c.object);
+			break;
+		case CommandType::BindUniformRange:
+			glBindBufferRange(GL_UNIFORM_BUFFER, c.slot, c.object, c.offset, c.size);
+			break;
+		case CommandType::DrawElements:
+			glDrawElementsBaseVertex(GL_TRIANGLES, c.count, GL_UNSIGNED_INT, (void*)c.offset, c.first);
+			break;
+		case CommandType::DrawArrays:
+			glDrawArrays(GL_TRIANGLES, c.first, c.count);
+			break;
+		}
+	}
+}
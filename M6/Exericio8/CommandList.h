@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+enum class CommandType : uint8_t
+{
+	UseProgram,
+	BindTexture,
+	BindVertexArray,
+	BindUniformRange,
+	DrawElements,
+	DrawArrays
+};
+
+// Comando gravado: s dados, nenhuma chamada  OpenGL, ento pode ser montado em
+// qualquer thread. Os campos usados dependem do tipo.
+struct RenderCommand
+{
+	CommandType type;
+	GLuint object;     //programa, textura, VAO ou buffer
+	GLuint slot;       //unidade de textura ou binding do bloco
+	GLintptr offset;   //trecho do buffer ou primeiro ndice (bytes)
+	GLsizeiptr size;
+	GLsizei count;
+	GLint first;       //baseVertex (elementos) ou primeiro vrtice (arrays)
+};
+
+// Lista de comandos de uma thread. As threads de trabalho gravam listas de trechos
+// disjuntos da cena; a thread da OpenGL executa as listas em ordem com replay(),
+// que passa pelo glState. Binds iguais ao anterior da mesma lista nem so gravados.
+class CommandList
+{
+public:
+	CommandList() { clear(); }
+
+	void clear();
+
+	void useProgram(GLuint program);
+	void bindTexture(GLuint unit, GLuint texture);
+	void bindVertexArray(GLuint vao);
+	void bindUniformRange(GLuint binding, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	void drawElements(GLsizei count, GLuint firstIndex, GLint baseVertex);
+	void drawArrays(GLint first, GLsizei count);
+
+	//S na thread da OpenGL
+	void replay() const;
+
+	size_t size() const { return commands.size(); }
+
+protected:
+	static const int MAX_UNITS = 4;
+
+	std::vector<RenderCommand> commands;
+	GLuint program, vao;
+	GLuint textures[MAX_UNITS];
+};
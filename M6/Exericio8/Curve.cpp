@@ -1,4 +1,5 @@
 #include "Curve.h"
+#include "HelloShader.h"
 
 void Curve::setShader(Shader* shader)
 {
@@ -8,13 +9,48 @@ void Curve::setShader(Shader* shader)
 
 void Curve::drawCurve(glm::vec4 color)
 {
-	shader->setVec4("finalColor", color.r, color.g, color.b, color.a);
+	shader->set(HelloShader::finalColor, color);
 
-	glBindVertexArray(VAO);
+	if (arena)
+	{
+		arena->draw(allocation, GL_LINE_STRIP);
+		return;
+	}
+
+	glState.bindVertexArray(VAO.ID);
 	// Chamada de desenho - drawcall
 	// CONTORNO e PONTOS - GL_LINE_LOOP e GL_POINTS
 	glDrawArrays(GL_LINE_STRIP, 0, curvePoints.size());
 	//glDrawArrays(GL_POINTS, 0, curvePoints.size());
-	glBindVertexArray(0);
 
+}
+
+void Curve::uploadCurve()
+{
+	if (arena)
+	{
+		if (allocation >= 0)
+			arena->free(allocation);
+		allocation = arena->allocate(curvePoints.data(), curvePoints.size());
+		return;
+	}
+
+	//Buffer imutvel com os pontos da curva - um novo generateCurve substitui o anterior
+	VBO.initialize(curvePoints.size() * sizeof(glm::vec3), curvePoints.data());
+
+	//Atributo posio (x, y, z) lido do binding 0
+	VAO.initialize();
+	VAO.setVertexBuffer(0, VBO, 0, sizeof(glm::vec3));
+	VAO.setAttribute(0, 0, 3, GL_FLOAT, 0);
+}
+
+void Curve::destroy()
+{
+	if (arena && allocation >= 0)
+	{
+		arena->free(allocation);
+		allocation = -1;
+	}
+	VAO.destroy();
+	VBO.destroy();
 }
\ No newline at end of file
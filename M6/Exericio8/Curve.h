@@ -9,23 +9,34 @@
 #include <vector> 
 
 #include "Shader.h"
+#include "GLResources.h"
+#include "GeometryArena.h"
 
 using namespace std;
 
 class Curve
 {
 public:
-	Curve() {}
+	Curve() : arena(nullptr), allocation(-1) {}
 	inline void setControlPoints(vector <glm::vec3> controlPoints) { this->controlPoints = controlPoints; }
 	void setShader(Shader* shader);
+	//Os pontos passam a ser sub-alocados na arena (formato s posio) em vez de um VAO prprio
+	inline void setArena(GeometryArena* arena) { this->arena = arena; }
 	void generateCurve(int pointsPerSegment);
 	void drawCurve(glm::vec4 color);
 	int getNbCurvePoints() { return curvePoints.size(); }
 	glm::vec3 getPointOnCurve(int i) { return curvePoints[i]; }
+	const vector<glm::vec3>& getCurvePoints() const { return curvePoints; }
+	void destroy();
 protected:
+	void uploadCurve();
+
 	vector <glm::vec3> controlPoints;
 	vector <glm::vec3> curvePoints;
 	glm::mat4 M; //Matriz de base
-	GLuint VAO;
+	VertexArray VAO;
+	Buffer VBO;
+	GeometryArena* arena;
+	int allocation;
 	Shader* shader;
 };
@@ -0,0 +1,69 @@
+#include "DepthPyramid.h"
+#include "GpuCullShaders.h"
+#include "GLResources.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DepthPyramid::initialize(Shader* reduceShader, int windowWidth, int windowHeight)
+{
+	this->reduceShader = reduceShader;
+	this->windowWidth = windowWidth;
+	this->windowHeight = windowHeight;
+	width = std::max(1, windowWidth / 2);
+	height = std::max(1, windowHeight / 2);
+	levels = 1 + (int)std::floor(std::log2((float)std::max(width, height)));
+	built = false;
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &pyramidTexture);
+	glTextureStorage2D(pyramidTexture, levels, GL_R32F, width, height);
+	glTextureParameteri(pyramidTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTextureParameteri(pyramidTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureParameteri(pyramidTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(pyramidTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void DepthPyramid::destroy()
+{
+	destroyTexture(pyramidTexture);
+	pyramidTexture = 0;
+	built = false;
+}
+
+void DepthPyramid::copyDepth(GLuint destinationFramebuffer, GLuint sourceFramebuffer, int sourceWidth, int sourceHeight) const
+{
+	if (sourceWidth <= 0 || sourceHeight <= 0)
+	{
+		sourceWidth = windowWidth;
+		sourceHeight = windowHeight;
+	}
+	//O blit de profundidade exige o mesmo formato dos dois lados (24 bits + stencil, padro do GLFW).
+	//A rea desenhada  esticada para a janela inteira: a pirmide continua em coordenadas de tela
+	glBlitNamedFramebuffer(sourceFramebuffer, destinationFramebuffer, 0, 0, sourceWidth, sourceHeight, 0, 0, windowWidth, windowHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+}
+
+void DepthPyramid::build(GLuint depthCopy)
+{
+
+	reduceShader->Use();
+	reduceShader->set(DepthPyramidShader::source, 1);
+	reduceShader->set(DepthPyramidShader::destination, 0);
+
+	int levelWidth = width, levelHeight = height;
+	for (int level = 0; level < levels; level++)
+	{
+		//Nvel 0 l a cpia do depth buffer; os outros, o nvel anterior da prpria pirmide
+		glState.bindTexture(1, GL_TEXTURE_2D, level == 0 ? depthCopy : pyramidTexture);
+		reduceShader->set(DepthPyramidShader::sourceLevel, level == 0 ? 0 : level - 1);
+		glBindImageTexture(0, pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		GLuint groupsX = (levelWidth + DepthPyramidShader::WORKGROUP_SIZE - 1) / DepthPyramidShader::WORKGROUP_SIZE;
+		GLuint groupsY = (levelHeight + DepthPyramidShader::WORKGROUP_SIZE - 1) / DepthPyramidShader::WORKGROUP_SIZE;
+		glDispatchCompute(groupsX, groupsY, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+	built = true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+#include "Shader.h"
+
+// Pirmide de profundidade (Hi-Z) montada a partir do depth buffer da janela no fim
+// do quadro. Cada texel guarda a profundidade mais distante da rea que cobre, ento
+// um objeto cuja profundidade mais prxima passa desse valor est escondido.
+// O nvel 0 tem metade da resoluo da janela. A cpia do depth buffer (textura
+// GL_DEPTH24_STENCIL8 do tamanho da janela)  de quem chama - no Origem, um
+// transiente do RenderGraph.
+class DepthPyramid
+{
+public:
+	DepthPyramid() : reduceShader(nullptr), windowWidth(0), windowHeight(0), width(0), height(0), levels(0), pyramidTexture(0), built(false) {}
+
+	void initialize(Shader* reduceShader, int windowWidth, int windowHeight);
+	void destroy();
+
+	//Copia a profundidade para destinationFramebuffer (com a cpia anexada). Por padro l a janela
+	//inteira; com resoluo dinmica, a rea sourceWidth x sourceHeight do framebuffer dado
+	void copyDepth(GLuint destinationFramebuffer, GLuint sourceFramebuffer = 0, int sourceWidth = 0, int sourceHeight = 0) const;
+	//Reduz a cpia nvel a nvel (chamar antes de glfwSwapBuffers)
+	void build(GLuint depthCopy);
+
+	//S fica pronta depois do primeiro build()
+	bool isReady() const { return built; }
+	GLuint getTexture() const { return pyramidTexture; }
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getLevels() const { return levels; }
+	int getWindowWidth() const { return windowWidth; }
+	int getWindowHeight() const { return windowHeight; }
+
+protected:
+	Shader* reduceShader;
+	int windowWidth, windowHeight;
+	int width, height, levels;
+	GLuint pyramidTexture; //R32F com todos os nveis
+	bool built;
+};
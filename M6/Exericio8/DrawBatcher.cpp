@@ -0,0 +1,93 @@
+#include "DrawBatcher.h"
+#include "GLState.h"
+#include "HelloShader.h"
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+bool DrawBatcher::add(Shader* shader, GeometryArena* arena, int allocation, GLuint textureID, const glm::mat4& model)
+{
+	if (arena->get(allocation).indexCount == 0)
+		return false;
+	items.push_back(DrawItem{ shader, arena, textureID, allocation, model });
+	return true;
+}
+
+void DrawBatcher::prepare()
+{
+	DrawBatcherStats stats = { (unsigned int)items.size(), 0, 0 };
+	batches.clear();
+
+	//Ordena ndices (no os itens) para agrupar por shader, arena e textura
+	order.resize(items.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = (int)i;
+	std::sort(order.begin(), order.end(), [this](int a, int b)
+		{
+			const DrawItem& x = items[a];
+			const DrawItem& y = items[b];
+			if (x.shader != y.shader) return x.shader < y.shader;
+			if (x.arena != y.arena) return x.arena < y.arena;
+			return x.textureID < y.textureID;
+		});
+
+	size_t begin = 0;
+	while (begin < order.size())
+	{
+		const DrawItem& first = items[order[begin]];
+		size_t end = begin + 1;
+		while (end < order.size() && items[order[end]].shader == first.shader && items[order[end]].arena == first.arena
+			&& items[order[end]].textureID == first.textureID)
+			end++;
+		GLsizei count = (GLsizei)(end - begin);
+
+		StreamAllocation commands = frameStream.allocate(count * sizeof(DrawElementsIndirectCommand), 4);
+		StreamAllocation drawData = frameStream.allocate(count * sizeof(glm::mat4), storageBufferAlignment());
+		if (!commands.data || !drawData.data)
+		{
+			//Sem espao tambm para o caminho por objeto (ObjectData vem do mesmo frameStream):
+			//o resto do quadro  descartado e contado
+			stats.dropped = (unsigned int)(order.size() - begin);
+			stats.draws -= stats.dropped;
+			if (!overflowReported)
+				std::cout << "ERROR::DRAW_BATCHER::STREAM_FULL (" << stats.dropped << " malhas descartadas)" << std::endl;
+			overflowReported = true;
+			break;
+		}
+
+		DrawElementsIndirectCommand* command = (DrawElementsIndirectCommand*)commands.data;
+		glm::mat4* models = (glm::mat4*)drawData.data;
+		for (GLsizei d = 0; d < count; d++)
+		{
+			const DrawItem& item = items[order[begin + d]];
+			const ArenaAllocation& a = item.arena->get(item.allocation);
+			command[d] = DrawElementsIndirectCommand{ a.indexCount, 1, a.firstIndex, a.baseVertex, 0 };
+			models[d] = item.model;
+		}
+
+		batches.push_back(Batch{ first.shader, first.arena, first.textureID, count, commands.offset, drawData.offset, drawData.size });
+		stats.batches++;
+		begin = end;
+	}
+
+	items.clear();
+	previous = stats;
+}
+
+void DrawBatcher::draw() const
+{
+	for (const Batch& batch : batches)
+	{
+		batch.shader->Use();
+		batch.shader->set(HelloShader::multiDraw, true);
+		glState.bindTexture(0, GL_TEXTURE_2D, batch.textureID);
+		glState.bindVertexArray(batch.arena->getVAO().ID);
+		glState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, frameStream.ID);
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, frameStream.ID, batch.drawDataOffset, batch.drawDataSize);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)batch.commandsOffset, batch.count, 0);
+		//As malhas desenhadas fora do lote voltam a usar o bloco ObjectData
+		batch.shader->set(HelloShader::multiDraw, false);
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "GeometryArena.h"
+
+// Comando lido pela GPU em glMultiDrawElementsIndirect (layout fixado pela especificao)
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+struct DrawBatcherStats
+{
+	unsigned int draws;   //Malhas desenhadas no quadro
+	unsigned int batches; //Chamadas glMultiDrawElementsIndirect
+	unsigned int dropped; //Malhas descartadas por falta de espao no frameStream
+};
+
+// Junta as malhas visveis do quadro por (shader, arena, textura) e desenha cada
+// grupo com uma nica glMultiDrawElementsIndirect. Os comandos e as matrizes
+// model vo para o frameStream; o hello.vs l a matriz com gl_DrawID.
+// prepare() escreve uma vez por quadro; draw() s repete as chamadas (pr-passagem).
+class DrawBatcher
+{
+public:
+	static const GLuint DRAW_DATA_BINDING = 1; //binding do SSBO DrawData no hello.vs
+
+	DrawBatcher() : overflowReported(false), previous{ 0, 0, 0 } {}
+
+	//S malhas indexadas da arena podem entrar no lote; retorna false para as outras
+	bool add(Shader* shader, GeometryArena* arena, int allocation, GLuint textureID, const glm::mat4& model);
+	//Agrupa, escreve comandos e matrizes no frameStream e esvazia a lista do quadro
+	void prepare();
+	//Desenha os lotes preparados; pode ser chamado mais de uma vez no quadro
+	void draw() const;
+
+	const DrawBatcherStats& lastFrame() const { return previous; }
+
+protected:
+	struct DrawItem
+	{
+		Shader* shader;
+		GeometryArena* arena;
+		GLuint textureID;
+		int allocation;
+		glm::mat4 model;
+	};
+	struct Batch
+	{
+		Shader* shader;
+		GeometryArena* arena;
+		GLuint textureID;
+		GLsizei count;
+		GLintptr commandsOffset;
+		GLintptr drawDataOffset;
+		GLsizeiptr drawDataSize;
+	};
+	std::vector<DrawItem> items;
+	std::vector<Batch> batches;
+	std::vector<int> order;
+	bool overflowReported; //O aviso de frameStream cheio sai s na primeira vez
+	DrawBatcherStats previous;
+};
@@ -0,0 +1,119 @@
+#include "DynamicResolution.h"
+#include "GLResources.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+void DynamicResolution::initialize(int windowWidth, int windowHeight, double targetTime, float minScale, float maxScale)
+{
+	destroy();
+	this->windowWidth = windowWidth;
+	this->windowHeight = windowHeight;
+	this->targetTime = targetTime;
+	this->minScale = minScale;
+	this->maxScale = maxScale;
+	scale = maxScale;
+	smoothedTime = 0.0;
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &colorTexture);
+	glTextureStorage2D(colorTexture, 1, GL_RGBA8, windowWidth, windowHeight);
+	glTextureParameteri(colorTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(colorTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	//Mesmo formato do depth buffer da janela, para a DepthPyramid poder copiar daqui
+	glCreateTextures(GL_TEXTURE_2D, 1, &depthTexture);
+	glTextureStorage2D(depthTexture, 1, GL_DEPTH24_STENCIL8, windowWidth, windowHeight);
+
+	glCreateFramebuffers(1, &framebuffer);
+	glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, colorTexture, 0);
+	glNamedFramebufferTexture(framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, depthTexture, 0);
+	if (glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE" << std::endl;
+
+	nFrames = 3;
+	frame = 0;
+	glCreateQueries(GL_TIME_ELAPSED, nFrames, queries);
+	for (int f = 0; f < MAX_FRAMES; f++)
+		issued[f] = false;
+	previous = ResolutionStats{ scale, getRenderWidth(), getRenderHeight(), 0.0 };
+}
+
+void DynamicResolution::destroy()
+{
+	if (framebuffer == 0)
+		return;
+	glDeleteQueries(nFrames, queries);
+	glDeleteFramebuffers(1, &framebuffer);
+	destroyTexture(colorTexture);
+	destroyTexture(depthTexture);
+	framebuffer = colorTexture = depthTexture = 0;
+	scale = 1.0f;
+}
+
+int DynamicResolution::getRenderWidth() const
+{
+	if (framebuffer == 0)
+		return 0;
+	return std::max(1, (int)(windowWidth * scale));
+}
+
+int DynamicResolution::getRenderHeight() const
+{
+	if (framebuffer == 0)
+		return 0;
+	return std::max(1, (int)(windowHeight * scale));
+}
+
+void DynamicResolution::beginFrame()
+{
+	if (framebuffer == 0)
+		return;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, getRenderWidth(), getRenderHeight());
+	glBeginQuery(GL_TIME_ELAPSED, queries[frame]);
+	issued[frame] = true;
+}
+
+void DynamicResolution::upscale()
+{
+	if (framebuffer == 0)
+		return;
+	//Ampliao bilinear da rea desenhada para a janela inteira
+	int renderWidth = getRenderWidth(), renderHeight = getRenderHeight();
+	glBlitNamedFramebuffer(framebuffer, 0, 0, 0, renderWidth, renderHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+}
+
+void DynamicResolution::endFrame()
+{
+	if (framebuffer == 0)
+		return;
+	glEndQuery(GL_TIME_ELAPSED);
+
+	//O quadro que volta a ser usado foi enviado h nFrames - 1 quadros
+	frame = (frame + 1) % nFrames;
+	if (!issued[frame])
+		return;
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(queries[frame], GL_QUERY_RESULT_AVAILABLE, &available);
+	issued[frame] = false;
+	if (!available)
+		return;
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(queries[frame], GL_QUERY_RESULT, &elapsed);
+	adjust(elapsed * 1e-9);
+}
+
+void DynamicResolution::adjust(double gpuTime)
+{
+	smoothedTime = smoothedTime == 0.0 ? gpuTime : smoothedTime + SMOOTHING * (gpuTime - smoothedTime);
+
+	//Com custo proporcional  rea, a escala que bate o alvo  scale * sqrt(alvo / medido)
+	float ideal = scale * (float)std::sqrt(targetTime / std::max(smoothedTime, 1e-6));
+	ideal = std::min(std::max(ideal, minScale), maxScale);
+	if (std::fabs(ideal - scale) >= DEADBAND)
+		scale += (ideal - scale) * GAIN;
+
+	previous = ResolutionStats{ scale, getRenderWidth(), getRenderHeight(), gpuTime };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+struct ResolutionStats
+{
+	float scale;     //Frao da resoluo da janela em cada eixo
+	int width, height;
+	double gpuTime;  //Tempo de GPU medido do quadro mais recente lido (s)
+};
+
+// Resoluo dinmica: a cena  desenhada em um framebuffer prprio, em um
+// viewport que  uma frao (scale) da janela, e ampliada para a janela no fim
+// do quadro. O tempo de GPU de cada quadro vem de consultas GL_TIME_ELAPSED em
+// anel (lidas s quando prontas) e um controlador ajusta scale para manter o
+// oramento: o custo  tratado como proporcional  rea, scale .
+// As texturas tm o tamanho da janela; s o viewport muda, ento nada  realocado.
+class DynamicResolution
+{
+public:
+	static const int MAX_FRAMES = 4;
+
+	DynamicResolution() : windowWidth(0), windowHeight(0), framebuffer(0), colorTexture(0), depthTexture(0), targetTime(0.0), minScale(0.5f), maxScale(1.0f),
+		scale(1.0f), smoothedTime(0.0), frame(0), nFrames(0), previous{ 1.0f, 0, 0, 0.0 } {}
+
+	//targetTime em segundos
+	void initialize(int windowWidth, int windowHeight, double targetTime, float minScale = 0.5f, float maxScale = 1.0f);
+	void destroy();
+	bool isEnabled() const { return framebuffer != 0; }
+
+	//Liga o framebuffer e o viewport do quadro e comea a medir (antes do glClear)
+	void beginFrame();
+	//Amplia a rea desenhada para a janela e volta a desenhar nela
+	void upscale();
+	//Termina a medio e ajusta a escala com o que j chegou da GPU
+	void endFrame();
+
+	//Framebuffer e rea em que a cena foi desenhada (tudo 0 se desabilitado: a janela)
+	GLuint getFramebuffer() const { return framebuffer; }
+	GLuint getColorTexture() const { return colorTexture; }
+	GLuint getDepthTexture() const { return depthTexture; }
+	int getRenderWidth() const;
+	int getRenderHeight() const;
+	float getScale() const { return scale; }
+	const ResolutionStats& lastFrame() const { return previous; }
+
+protected:
+	//Frao da diferena entre a escala ideal e a atual aplicada por leitura
+	static constexpr float GAIN = 0.5f;
+	//Mudanas menores que isso so ignoradas (evita oscilar em volta do alvo)
+	static constexpr float DEADBAND = 0.02f;
+	//Peso de cada leitura nova na mdia do tempo de GPU
+	static constexpr double SMOOTHING = 0.2;
+
+	void adjust(double gpuTime);
+
+	int windowWidth, windowHeight;
+	GLuint framebuffer, colorTexture, depthTexture;
+	double targetTime;
+	float minScale, maxScale, scale;
+	double smoothedTime;
+
+	GLuint queries[MAX_FRAMES];
+	bool issued[MAX_FRAMES];
+	int frame, nFrames;
+	ResolutionStats previous;
+};
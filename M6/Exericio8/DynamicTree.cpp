@@ -0,0 +1,273 @@
+#include "DynamicTree.h"
+
+#include <algorithm>
+#include <cassert>
+
+DynamicTree::DynamicTree() : root(NULL_NODE), freeList(NULL_NODE), proxyCount(0)
+{
+}
+
+float DynamicTree::area(const BoundingBox& box)
+{
+	glm::vec3 d = box.max - box.min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+BoundingBox DynamicTree::combine(const BoundingBox& a, const BoundingBox& b)
+{
+	return BoundingBox{ glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+bool DynamicTree::contains(const BoundingBox& outer, const BoundingBox& inner)
+{
+	return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::lessThanEqual(inner.max, outer.max));
+}
+
+bool DynamicTree::overlaps(const BoundingBox& a, const BoundingBox& b)
+{
+	return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+}
+
+int DynamicTree::allocateNode()
+{
+	if (freeList == NULL_NODE)
+	{
+		nodes.push_back(TreeNode{});
+		nodes.back().next = NULL_NODE;
+		nodes.back().height = -1;
+		freeList = (int)nodes.size() - 1;
+	}
+
+	int id = freeList;
+	freeList = nodes[id].next;
+	nodes[id].parent = NULL_NODE;
+	nodes[id].child1 = NULL_NODE;
+	nodes[id].child2 = NULL_NODE;
+	nodes[id].height = 0;
+	nodes[id].userData = nullptr;
+	return id;
+}
+
+void DynamicTree::freeNode(int node)
+{
+	nodes[node].next = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+int DynamicTree::createProxy(const BoundingBox& box, void* userData)
+{
+	int id = allocateNode();
+	nodes[id].box = BoundingBox{ box.min - glm::vec3(FAT_MARGIN), box.max + glm::vec3(FAT_MARGIN) };
+	nodes[id].userData = userData;
+	insertLeaf(id);
+	proxyCount++;
+	return id;
+}
+
+void DynamicTree::destroyProxy(int proxyId)
+{
+	assert(nodes[proxyId].isLeaf());
+	removeLeaf(proxyId);
+	freeNode(proxyId);
+	proxyCount--;
+}
+
+bool DynamicTree::moveProxy(int proxyId, const BoundingBox& box, const glm::vec3& displacement)
+{
+	//Caixa gorda nova: margem fixa e o deslocamento estendido na direo do movimento
+	BoundingBox fat{ box.min - glm::vec3(FAT_MARGIN), box.max + glm::vec3(FAT_MARGIN) };
+	glm::vec3 d = displacement * DISPLACEMENT_FACTOR;
+	fat.min += glm::min(d, glm::vec3(0.0f));
+	fat.max += glm::max(d, glm::vec3(0.0f));
+
+	const BoundingBox& current = nodes[proxyId].box;
+	if (contains(current, box))
+	{
+		//A caixa atual ainda serve, a no ser que tenha ficado grande demais (objeto parou ou encolheu)
+		BoundingBox huge{ fat.min - glm::vec3(4.0f * FAT_MARGIN), fat.max + glm::vec3(4.0f * FAT_MARGIN) };
+		if (contains(huge, current))
+			return false;
+	}
+
+	removeLeaf(proxyId);
+	nodes[proxyId].box = fat;
+	insertLeaf(proxyId);
+	return true;
+}
+
+void DynamicTree::insertLeaf(int leaf)
+{
+	if (root == NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	//Desce pela rvore escolhendo o irmo de menor custo (heurstica de rea de superfcie)
+	BoundingBox leafBox = nodes[leaf].box;
+	int index = root;
+	while (!nodes[index].isLeaf())
+	{
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+
+		float nodeArea = area(nodes[index].box);
+		float combinedArea = area(combine(nodes[index].box, leafBox));
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - nodeArea);
+
+		float cost1 = area(combine(leafBox, nodes[child1].box)) + inheritanceCost;
+		if (!nodes[child1].isLeaf())
+			cost1 -= area(nodes[child1].box);
+		float cost2 = area(combine(leafBox, nodes[child2].box)) + inheritanceCost;
+		if (!nodes[child2].isLeaf())
+			cost2 -= area(nodes[child2].box);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+		index = cost1 < cost2 ? child1 : child2;
+	}
+	int sibling = index;
+
+	//Novo pai para o irmo e a folha
+	int oldParent = nodes[sibling].parent;
+	int newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == NULL_NODE)
+		root = newParent;
+	else if (nodes[oldParent].child1 == sibling)
+		nodes[oldParent].child1 = newParent;
+	else
+		nodes[oldParent].child2 = newParent;
+
+	//Sobe corrigindo caixas e alturas
+	index = nodes[leaf].parent;
+	while (index != NULL_NODE)
+	{
+		index = balance(index);
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+		nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[index].box = combine(nodes[child1].box, nodes[child2].box);
+		index = nodes[index].parent;
+	}
+}
+
+void DynamicTree::removeLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent == NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+		freeNode(parent);
+		return;
+	}
+
+	//O irmo assume o lugar do pai
+	if (nodes[grandParent].child1 == parent)
+		nodes[grandParent].child1 = sibling;
+	else
+		nodes[grandParent].child2 = sibling;
+	nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	int index = grandParent;
+	while (index != NULL_NODE)
+	{
+		index = balance(index);
+		int child1 = nodes[index].child1;
+		int child2 = nodes[index].child2;
+		nodes[index].box = combine(nodes[child1].box, nodes[child2].box);
+		nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		index = nodes[index].parent;
+	}
+}
+
+// Rotao quando um filho est 2 nveis mais alto que o outro: o neto mais alto sobe
+// para o lugar do filho. Retorna o n que ficou na posio de iA.
+int DynamicTree::balance(int iA)
+{
+	TreeNode* A = &nodes[iA];
+	if (A->isLeaf() || A->height < 2)
+		return iA;
+
+	int iB = A->child1;
+	int iC = A->child2;
+	TreeNode* B = &nodes[iB];
+	TreeNode* C = &nodes[iC];
+
+	int heightDifference = C->height - B->height;
+	if (heightDifference < 2 && heightDifference > -2)
+		return iA;
+
+	//O filho mais alto (C em "sobe C"; B no caso simtrico) vira a raiz da sub-rvore
+	bool raiseC = heightDifference > 0;
+	int iUp = raiseC ? iC : iB;
+	int iOther = raiseC ? iB : iC;
+	TreeNode* Up = &nodes[iUp];
+
+	int iF = Up->child1;
+	int iG = Up->child2;
+	TreeNode* F = &nodes[iF];
+	TreeNode* G = &nodes[iG];
+
+	Up->child1 = iA;
+	Up->parent = A->parent;
+	A->parent = iUp;
+
+	if (Up->parent == NULL_NODE)
+		root = iUp;
+	else if (nodes[Up->parent].child1 == iA)
+		nodes[Up->parent].child1 = iUp;
+	else
+		nodes[Up->parent].child2 = iUp;
+
+	//O neto mais alto fica com Up; o outro desce para A no lugar de Up
+	int iKeep = F->height > G->height ? iF : iG;
+	int iMove = F->height > G->height ? iG : iF;
+	Up->child2 = iKeep;
+	if (raiseC)
+		A->child2 = iMove;
+	else
+		A->child1 = iMove;
+	nodes[iMove].parent = iA;
+
+	const TreeNode& other = nodes[iOther];
+	A->box = combine(other.box, nodes[iMove].box);
+	Up->box = combine(A->box, nodes[iKeep].box);
+	A->height = 1 + std::max(other.height, nodes[iMove].height);
+	Up->height = 1 + std::max(A->height, nodes[iKeep].height);
+	return iUp;
+}
+
+float DynamicTree::getAreaRatio() const
+{
+	if (root == NULL_NODE)
+		return 0.0f;
+
+	float rootArea = area(nodes[root].box);
+	float totalArea = 0.0f;
+	for (const TreeNode& node : nodes)
+		if (node.height > 0)
+			totalArea += area(node.box);
+	return rootArea > 0.0f ? totalArea / rootArea : 0.0f;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "FrustumCuller.h"
+
+// rvore AABB dinmica em 3D, no modelo do b2DynamicTree do box2d (M1/dependencies).
+// As folhas guardam caixas "gordas" (margem + deslocamento previsto), ento um objeto
+// que se move pouco no mexe na rvore; quando sai da caixa gorda ele  removido e
+// reinserido, e as rotaes em balance() mantm a altura baixa sem reconstruir tudo.
+// Os ns ficam em um vetor e so referenciados por ndice.
+class DynamicTree
+{
+public:
+	static const int NULL_NODE = -1;
+	static constexpr float FAT_MARGIN = 0.1f;      //folga fixa em cada lado da caixa
+	static constexpr float DISPLACEMENT_FACTOR = 4.0f; //quantos deslocamentos a caixa gorda antecipa
+
+	DynamicTree();
+
+	//Retorna o identificador do proxy (ndice do n folha)
+	int createProxy(const BoundingBox& box, void* userData);
+	void destroyProxy(int proxyId);
+	//Retorna true quando o proxy precisou ser reinserido
+	bool moveProxy(int proxyId, const BoundingBox& box, const glm::vec3& displacement);
+
+	void* getUserData(int proxyId) const { return nodes[proxyId].userData; }
+	const BoundingBox& getFatBox(int proxyId) const { return nodes[proxyId].box; }
+
+	//callback(proxyId) para cada proxy cuja caixa gorda cruza a caixa; retorna false para parar
+	template <typename Callback>
+	void query(const BoundingBox& box, Callback callback) const;
+
+	//callback(proxyId) para cada proxy dentro do frustum. Sub-rvores inteiramente dentro
+	//no so mais testadas. Retorna quantos ns foram testados.
+	template <typename Callback>
+	int query(const Frustum& frustum, Callback callback) const;
+
+	//callback(proxyId, maxDistance) faz o teste exato e retorna a nova distncia mxima
+	//(0 encerra, maxDistance continua, a distncia do acerto corta o raio)
+	template <typename Callback>
+	void rayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback callback) const;
+
+	int getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+	int getProxyCount() const { return proxyCount; }
+	//Soma das reas dos ns internos sobre a rea da raiz (qualidade da rvore)
+	float getAreaRatio() const;
+
+protected:
+	struct TreeNode
+	{
+		BoundingBox box;
+		void* userData;
+		union
+		{
+			int parent;
+			int next;
+		};
+		int child1;
+		int child2;
+		int height; //folha = 0, n livre = -1
+
+		bool isLeaf() const { return child1 == NULL_NODE; }
+	};
+
+	int allocateNode();
+	void freeNode(int node);
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	int balance(int node);
+
+	static float area(const BoundingBox& box);
+	static BoundingBox combine(const BoundingBox& a, const BoundingBox& b);
+	static bool contains(const BoundingBox& outer, const BoundingBox& inner);
+	static bool overlaps(const BoundingBox& a, const BoundingBox& b);
+
+	int root;
+	std::vector<TreeNode> nodes;
+	int freeList;
+	int proxyCount;
+	mutable std::vector<int> stack;
+};
+
+template <typename Callback>
+void DynamicTree::query(const BoundingBox& box, Callback callback) const
+{
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int id = stack.back();
+		stack.pop_back();
+		if (id == NULL_NODE || !overlaps(nodes[id].box, box))
+			continue;
+
+		const TreeNode& node = nodes[id];
+		if (node.isLeaf())
+		{
+			if (!callback(id))
+				return;
+			continue;
+		}
+		stack.push_back(node.child1);
+		stack.push_back(node.child2);
+	}
+}
+
+template <typename Callback>
+int DynamicTree::query(const Frustum& frustum, Callback callback) const
+{
+	//Cada entrada guarda o n e se ele j se sabe inteiramente dentro do frustum (bit 0)
+	int tested = 0;
+	stack.clear();
+	if (root != NULL_NODE)
+		stack.push_back(root << 1);
+	while (!stack.empty())
+	{
+		int entry = stack.back();
+		stack.pop_back();
+		int id = entry >> 1;
+		bool inside = (entry & 1) != 0;
+		const TreeNode& node = nodes[id];
+
+		if (!inside)
+		{
+			tested++;
+			FrustumTest result = frustum.test(node.box);
+			if (result == FrustumTest::Outside)
+				continue;
+			inside = result == FrustumTest::Inside;
+		}
+
+		if (node.isLeaf())
+		{
+			callback(id);
+			continue;
+		}
+		stack.push_back((node.child1 << 1) | (inside ? 1 : 0));
+		stack.push_back((node.child2 << 1) | (inside ? 1 : 0));
+	}
+	return tested;
+}
+
+template <typename Callback>
+void DynamicTree::rayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback callback) const
+{
+	glm::vec3 inverse = 1.0f / direction;
+
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int id = stack.back();
+		stack.pop_back();
+		if (id == NULL_NODE)
+			continue;
+
+		//Teste de slabs contra a caixa do n, cortado pela distncia mxima atual
+		const TreeNode& node = nodes[id];
+		glm::vec3 t1 = (node.box.min - origin) * inverse;
+		glm::vec3 t2 = (node.box.max - origin) * inverse;
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+		float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+		if (enter > exit)
+			continue;
+
+		if (node.isLeaf())
+		{
+			float value = callback(id, maxDistance);
+			if (value == 0.0f)
+				return;
+			if (value > 0.0f)
+				maxDistance = value;
+			continue;
+		}
+		stack.push_back(node.child1);
+		stack.push_back(node.child2);
+	}
+}
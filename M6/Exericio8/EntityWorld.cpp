@@ -0,0 +1,203 @@
+#include "EntityWorld.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+	struct TypeInfo
+	{
+		size_t size, alignment;
+	};
+	std::vector<TypeInfo>& typeInfos()
+	{
+		static std::vector<TypeInfo> infos;
+		return infos;
+	}
+}
+
+int ComponentTypes::registerType(size_t size, size_t alignment)
+{
+	//O tipo vira um bit do ComponentMask e um ndice de Archetype::offsets
+	assert((int)typeInfos().size() < MAX_TYPES && "mais de MAX_TYPES tipos de componente");
+	typeInfos().push_back(TypeInfo{ size, alignment });
+	return (int)typeInfos().size() - 1;
+}
+
+size_t ComponentTypes::size(int type)
+{
+	return typeInfos()[type].size;
+}
+
+size_t ComponentTypes::alignment(int type)
+{
+	return typeInfos()[type].alignment;
+}
+
+EntityWorld::EntityWorld() : entityCount(0)
+{
+}
+
+int EntityWorld::getChunkCount() const
+{
+	int count = 0;
+	for (const Archetype& archetype : archetypes)
+		count += (int)archetype.chunks.size();
+	return count;
+}
+
+int EntityWorld::findArchetype(ComponentMask mask)
+{
+	for (size_t a = 0; a < archetypes.size(); a++)
+		if (archetypes[a].mask == mask)
+			return (int)a;
+
+	//Capacidade: quantas entidades cabem com cada array alinhado; comea pela diviso direta e desce at caber
+	Archetype archetype;
+	archetype.mask = mask;
+	size_t bytesPerEntity = sizeof(Entity);
+	for (int type = 0; type < ComponentTypes::MAX_TYPES; type++)
+		if (mask & (ComponentMask(1) << type))
+			bytesPerEntity += ComponentTypes::size(type);
+
+	//Desce at 1 (componentes grandes); se nem uma entidade cabe, o arqutipo  recusado
+	auto alignUp = [](size_t value) { return (value + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT; };
+	bool fits = false;
+	for (archetype.capacity = std::max(1, (int)(CHUNK_BYTES / bytesPerEntity)); archetype.capacity >= 1; archetype.capacity--)
+	{
+		size_t offset = alignUp(archetype.capacity * sizeof(Entity));
+		for (int type = 0; type < ComponentTypes::MAX_TYPES; type++)
+		{
+			if (!(mask & (ComponentMask(1) << type)))
+				continue;
+			archetype.offsets[type] = offset;
+			offset = alignUp(offset + archetype.capacity * ComponentTypes::size(type));
+		}
+		fits = offset <= CHUNK_BYTES;
+		if (fits)
+			break;
+	}
+	if (!fits)
+	{
+		//Os arrays passariam do fim do chunk: no h como continuar sem corromper a memria
+		std::cout << "ERROR::ENTITY_WORLD::ARCHETYPE_TOO_LARGE (" << bytesPerEntity << " bytes por entidade)" << std::endl;
+		std::abort();
+	}
+
+	archetypes.push_back(std::move(archetype));
+	return (int)archetypes.size() - 1;
+}
+
+Entity EntityWorld::allocateEntity(int archetype)
+{
+	uint32_t index;
+	if (!freeIndices.empty())
+	{
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else
+	{
+		index = (uint32_t)records.size();
+		records.push_back(EntityRecord{ 0, -1, 0, 0 });
+	}
+
+	EntityRecord& record = records[index];
+	record.archetype = archetype;
+	allocateRow(archetype, record.chunk, record.row);
+	Entity entity = { index, record.generation };
+	Archetype& owner = archetypes[archetype];
+	owner.entities(*owner.chunks[record.chunk])[record.row] = entity;
+	entityCount++;
+	return entity;
+}
+
+Entity EntityWorld::create()
+{
+	return allocateEntity(findArchetype(0));
+}
+
+void EntityWorld::allocateRow(int archetype, int& chunk, int& row)
+{
+	Archetype& owner = archetypes[archetype];
+	if (owner.chunks.empty() || owner.chunks.back()->count == owner.capacity)
+	{
+		owner.chunks.push_back(std::unique_ptr<Chunk>(new Chunk));
+		owner.chunks.back()->count = 0;
+	}
+	chunk = (int)owner.chunks.size() - 1;
+	row = owner.chunks.back()->count++;
+}
+
+void EntityWorld::removeRow(int archetype, int chunk, int row)
+{
+	Archetype& owner = archetypes[archetype];
+	Chunk& last = *owner.chunks.back();
+	int lastRow = last.count - 1;
+	Chunk& hole = *owner.chunks[chunk];
+
+	if (&hole != &last || row != lastRow)
+	{
+		Entity moved = owner.entities(last)[lastRow];
+		owner.entities(hole)[row] = moved;
+		for (int type = 0; type < ComponentTypes::MAX_TYPES; type++)
+			if (owner.mask & (ComponentMask(1) << type))
+				memcpy(owner.component(hole, type, row), owner.component(last, type, lastRow), ComponentTypes::size(type));
+		records[moved.index].chunk = chunk;
+		records[moved.index].row = row;
+	}
+
+	if (--last.count == 0)
+		owner.chunks.pop_back();
+}
+
+void EntityWorld::destroy(Entity entity)
+{
+	if (!isAlive(entity))
+		return;
+	EntityRecord& record = records[entity.index];
+	removeRow(record.archetype, record.chunk, record.row);
+	record.archetype = -1;
+	record.generation++;
+	freeIndices.push_back(entity.index);
+	entityCount--;
+}
+
+bool EntityWorld::isAlive(Entity entity) const
+{
+	return entity.index < records.size() && records[entity.index].archetype >= 0 && records[entity.index].generation == entity.generation;
+}
+
+void EntityWorld::moveEntity(Entity entity, ComponentMask mask)
+{
+	int target = findArchetype(mask);
+	EntityRecord& record = records[entity.index];
+	int chunk, row;
+	allocateRow(target, chunk, row);
+
+	Archetype& from = archetypes[record.archetype];
+	Archetype& to = archetypes[target];
+	Chunk& source = *from.chunks[record.chunk];
+	Chunk& destination = *to.chunks[chunk];
+	to.entities(destination)[row] = entity;
+	ComponentMask shared = from.mask & to.mask;
+	for (int type = 0; type < ComponentTypes::MAX_TYPES; type++)
+		if (shared & (ComponentMask(1) << type))
+			memcpy(to.component(destination, type, row), from.component(source, type, record.row), ComponentTypes::size(type));
+
+	removeRow(record.archetype, record.chunk, record.row);
+	record.archetype = target;
+	record.chunk = chunk;
+	record.row = row;
+}
+
+void EntityWorld::matchingChunks(ComponentMask mask, std::vector<std::pair<int, int>>& result)
+{
+	result.clear();
+	for (size_t a = 0; a < archetypes.size(); a++)
+		if ((archetypes[a].mask & mask) == mask)
+			for (size_t c = 0; c < archetypes[a].chunks.size(); c++)
+				result.push_back(std::make_pair((int)a, (int)c));
+}
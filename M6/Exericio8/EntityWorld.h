@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "JobSystem.h"
+
+typedef uint64_t ComponentMask;
+
+struct Entity
+{
+	uint32_t index;
+	uint32_t generation;
+
+	bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// Identificador de cada tipo de componente, atribudo no primeiro uso (at 64 tipos).
+// Componentes so dados simples: so movidos entre chunks com memcpy.
+class ComponentTypes
+{
+public:
+	static const int MAX_TYPES = 64;
+
+	template <typename T>
+	static int id()
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "componentes precisam ser copiveis com memcpy");
+		static const int value = registerType(sizeof(T), alignof(T));
+		return value;
+	}
+
+	template <typename... C>
+	static ComponentMask mask() { return (ComponentMask(0) | ... | (ComponentMask(1) << id<C>())); }
+
+	static size_t size(int type);
+	static size_t alignment(int type);
+
+private:
+	static int registerType(size_t size, size_t alignment);
+};
+
+// Entidades guardadas por arqutipo (o conjunto exato de componentes que tm).
+// Cada arqutipo tem chunks de CHUNK_BYTES; dentro de um chunk cada componente 
+// um array contguo (e o array de Entity vem antes), ento um sistema que l
+// Transform e Bounds percorre dois arrays lineares sem seguir ponteiros.
+// Os chunks ficam cheios: remover uma entidade traz a ltima do arqutipo para
+// o lugar dela. Adicionar ou remover um componente muda a entidade de arqutipo.
+// Mudanas de estrutura (create/destroy/add/remove) no podem acontecer durante
+// forEachChunk/parallelForEachChunk.
+class EntityWorld
+{
+public:
+	static const size_t CHUNK_BYTES = 16 * 1024;
+	//Alinhamento de cada array no chunk (permite loads SIMD alinhados)
+	static const size_t ARRAY_ALIGNMENT = 32;
+
+	EntityWorld();
+
+	Entity create();
+	//Cria j no arqutipo final, sem passar pelos intermedirios
+	template <typename... C>
+	Entity create(const C&... components);
+	void destroy(Entity entity);
+	bool isAlive(Entity entity) const;
+
+	template <typename T>
+	void add(Entity entity, const T& component);
+	template <typename T>
+	void remove(Entity entity);
+	//nullptr quando a entidade no tem o componente
+	template <typename T>
+	T* get(Entity entity);
+
+	//callback(count, entities, arrays...) para cada chunk com todos os componentes pedidos
+	template <typename... C, typename Callback>
+	void forEachChunk(Callback callback);
+	//O mesmo, com os chunks divididos entre as threads do JobSystem
+	template <typename... C, typename Callback>
+	void parallelForEachChunk(Callback callback);
+
+	int getEntityCount() const { return entityCount; }
+	int getArchetypeCount() const { return (int)archetypes.size(); }
+	int getChunkCount() const;
+
+protected:
+	struct Chunk
+	{
+		alignas(ARRAY_ALIGNMENT) unsigned char data[CHUNK_BYTES];
+		int count;
+	};
+
+	struct Archetype
+	{
+		ComponentMask mask;
+		int capacity;
+		size_t offsets[ComponentTypes::MAX_TYPES]; //S valem os tipos do mask
+		std::vector<std::unique_ptr<Chunk>> chunks;
+
+		Entity* entities(Chunk& chunk) { return (Entity*)chunk.data; }
+		unsigned char* component(Chunk& chunk, int type, int row) { return chunk.data + offsets[type] + (size_t)row * ComponentTypes::size(type); }
+		template <typename T>
+		T* array(Chunk& chunk) { return (T*)(chunk.data + offsets[ComponentTypes::id<T>()]); }
+	};
+
+	struct EntityRecord
+	{
+		uint32_t generation;
+		int archetype; //-1 quando o ndice est livre
+		int chunk;
+		int row;
+	};
+
+	int findArchetype(ComponentMask mask);
+	Entity allocateEntity(int archetype);
+	//Lugar no fim do arqutipo (cria um chunk se o ltimo est cheio)
+	void allocateRow(int archetype, int& chunk, int& row);
+	//Tira a entidade do lugar atual, trazendo a ltima do arqutipo para ele
+	void removeRow(int archetype, int chunk, int row);
+	//Muda a entidade para o arqutipo com o mask, copiando os componentes em comum
+	void moveEntity(Entity entity, ComponentMask mask);
+	//Chunks (arqutipo, ndice) com todos os componentes do mask
+	void matchingChunks(ComponentMask mask, std::vector<std::pair<int, int>>& result);
+
+	std::vector<Archetype> archetypes;
+	std::vector<EntityRecord> records;
+	std::vector<uint32_t> freeIndices;
+	int entityCount;
+};
+
+template <typename... C>
+Entity EntityWorld::create(const C&... components)
+{
+	static_assert(sizeof(Entity) + (sizeof(C) + ... + 0) + (sizeof...(C) + 1) * ARRAY_ALIGNMENT <= CHUNK_BYTES,
+		"uma entidade com esses componentes no cabe em um chunk");
+	Entity entity = allocateEntity(findArchetype(ComponentTypes::mask<C...>()));
+	EntityRecord& record = records[entity.index];
+	Archetype& archetype = archetypes[record.archetype];
+	Chunk& chunk = *archetype.chunks[record.chunk];
+	(memcpy(archetype.component(chunk, ComponentTypes::id<C>(), record.row), &components, sizeof(C)), ...);
+	return entity;
+}
+
+template <typename T>
+void EntityWorld::add(Entity entity, const T& component)
+{
+	static_assert(sizeof(Entity) + sizeof(T) + 2 * ARRAY_ALIGNMENT <= CHUNK_BYTES, "componente maior que um chunk");
+	if (!isAlive(entity))
+		return;
+	int type = ComponentTypes::id<T>();
+	ComponentMask mask = archetypes[records[entity.index].archetype].mask;
+	if (!(mask & (ComponentMask(1) << type)))
+		moveEntity(entity, mask | (ComponentMask(1) << type));
+	*get<T>(entity) = component;
+}
+
+template <typename T>
+void EntityWorld::remove(Entity entity)
+{
+	if (!isAlive(entity))
+		return;
+	ComponentMask mask = archetypes[records[entity.index].archetype].mask;
+	ComponentMask bit = ComponentMask(1) << ComponentTypes::id<T>();
+	if (mask & bit)
+		moveEntity(entity, mask & ~bit);
+}
+
+template <typename T>
+T* EntityWorld::get(Entity entity)
+{
+	if (!isAlive(entity))
+		return nullptr;
+	const EntityRecord& record = records[entity.index];
+	Archetype& archetype = archetypes[record.archetype];
+	int type = ComponentTypes::id<T>();
+	if (!(archetype.mask & (ComponentMask(1) << type)))
+		return nullptr;
+	return (T*)archetype.component(*archetype.chunks[record.chunk], type, record.row);
+}
+
+template <typename... C, typename Callback>
+void EntityWorld::forEachChunk(Callback callback)
+{
+	ComponentMask mask = ComponentTypes::mask<C...>();
+	for (Archetype& archetype : archetypes)
+	{
+		if ((archetype.mask & mask) != mask)
+			continue;
+		for (std::unique_ptr<Chunk>& chunk : archetype.chunks)
+			callback(chunk->count, archetype.entities(*chunk), archetype.template array<C>(*chunk)...);
+	}
+}
+
+template <typename... C, typename Callback>
+void EntityWorld::parallelForEachChunk(Callback callback)
+{
+	std::vector<std::pair<int, int>> chunks;
+	matchingChunks(ComponentTypes::mask<C...>(), chunks);
+	jobSystem.parallelFor((int)chunks.size(), 1, [&](int begin, int end)
+		{
+			for (int c = begin; c < end; c++)
+			{
+				Archetype& archetype = archetypes[chunks[c].first];
+				Chunk& chunk = *archetype.chunks[chunks[c].second];
+				callback(chunk.count, archetype.entities(chunk), archetype.template array<C>(chunk)...);
+			}
+		});
+}
@@ -0,0 +1,32 @@
+#include "FixedTimestep.h"
+
+void FixedTimestep::initialize(double step, int maxSteps)
+{
+	this->step = step > 0.0 ? step : 1.0 / 60.0;
+	this->maxSteps = maxSteps < 1 ? 1 : maxSteps;
+	accumulator = 0.0;
+	lastTime = -1.0;
+	previous = FixedTimestepStats{};
+}
+
+int FixedTimestep::advance(double now)
+{
+	//A primeira chamada s marca o tempo: o estado inicial  desenhado sem avanar
+	if (lastTime >= 0.0)
+		accumulator += now - lastTime;
+	lastTime = now;
+
+	int steps = (int)(accumulator / step);
+	double dropped = 0.0;
+	if (steps > maxSteps)
+	{
+		dropped = (steps - maxSteps) * step;
+		steps = maxSteps;
+	}
+	accumulator -= (steps * step) + dropped;
+
+	previous.steps = steps;
+	previous.droppedTime = dropped;
+	previous.alpha = getAlpha();
+	return steps;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+struct FixedTimestepStats
+{
+	unsigned int steps;  //Passos simulados no quadro
+	double droppedTime;  //Tempo descartado por passar do limite de passos (s)
+	float alpha;         //Frao do passo usada para interpolar o desenho
+};
+
+// Relgio de passo fixo: o tempo real entre os quadros vai para um acumulador
+// e a simulao avana em passos de tamanho constante enquanto houver tempo
+// acumulado. O que sobra (menos de um passo) vira alpha, e o desenho interpola
+// entre os dois ltimos estados simulados. O resultado no depende da taxa de
+// quadros; quando o quadro demora demais, no mximo maxSteps passos rodam e o
+// resto do tempo  descartado (a animao fica mais lenta em vez de travar).
+class FixedTimestep
+{
+public:
+	FixedTimestep() : step(1.0 / 60.0), maxSteps(5), accumulator(0.0), lastTime(-1.0), previous{} {}
+
+	//step em segundos
+	void initialize(double step, int maxSteps = 5);
+
+	//Soma o tempo desde a chamada anterior e retorna quantos passos simular agora
+	int advance(double now);
+	float getAlpha() const { return (float)(accumulator / step); }
+	double getStep() const { return step; }
+
+	const FixedTimestepStats& lastFrame() const { return previous; }
+
+protected:
+	double step;
+	int maxSteps;
+	double accumulator;
+	double lastTime;
+	FixedTimestepStats previous;
+};
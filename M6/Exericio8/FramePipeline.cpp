@@ -0,0 +1,85 @@
+#include "FramePipeline.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+void FramePipeline::initialize(bool threaded)
+{
+	destroy();
+	this->threaded = threaded;
+	hasJob = stopping = false;
+	if (threaded)
+		worker = std::thread(&FramePipeline::run, this);
+}
+
+void FramePipeline::destroy()
+{
+	if (!worker.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+	threaded = false;
+}
+
+void FramePipeline::kick(const std::function<void()>& job)
+{
+	if (!threaded)
+	{
+		double start = glfwGetTime();
+		job();
+		current.simulationTime = glfwGetTime() - start;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = job;
+		hasJob = true;
+	}
+	wake.notify_one();
+}
+
+void FramePipeline::wait()
+{
+	if (!threaded)
+		return;
+
+	double start = glfwGetTime();
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]() { return !hasJob; });
+	current.waitTime = glfwGetTime() - start;
+	current.simulationTime = jobTime;
+}
+
+void FramePipeline::endFrame(double latency)
+{
+	current.latency = latency;
+	previous = current;
+	current = FramePipelineStats{};
+}
+
+void FramePipeline::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		wake.wait(lock, [this]() { return hasJob || stopping; });
+		if (stopping)
+			return;
+
+		//O trabalho roda sem o mutex: a thread da OpenGL s volta a tocar nele em wait()
+		lock.unlock();
+		double start = glfwGetTime();
+		job();
+		double elapsed = glfwGetTime() - start;
+		lock.lock();
+
+		jobTime = elapsed;
+		hasJob = false;
+		done.notify_one();
+	}
+}
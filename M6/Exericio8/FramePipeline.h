@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct FramePipelineStats
+{
+	double simulationTime; //Simulao do quadro (na thread prpria quando em pipeline)
+	double waitTime;       //Tempo que a thread da OpenGL ficou parada esperando a simulao
+	double latency;        //Da leitura da entrada at o glfwSwapBuffers do quadro que a usou
+};
+
+// Quadros em pipeline: enquanto a thread da OpenGL envia o quadro N, uma thread
+// prpria j simula o quadro N+1. Cada quadro  um trabalho entregue em kick();
+// wait() bloqueia at o trabalho anterior terminar. Quem chama alterna entre
+// dois snapshots: a simulao escreve em um enquanto o envio l o outro, ento
+// nenhum dado  compartilhado entre as threads durante o quadro.
+// O custo  um quadro a mais entre a entrada e a tela, medido em latency.
+// Sem pipeline, kick() roda o trabalho na hora, na thread que chamou.
+class FramePipeline
+{
+public:
+	FramePipeline() : threaded(false), hasJob(false), stopping(false), jobTime(0.0), previous{}, current{} {}
+
+	void initialize(bool threaded);
+	void destroy();
+	bool isThreaded() const { return threaded; }
+
+	//Entrega o trabalho do prximo quadro (o anterior precisa ter passado por wait)
+	void kick(const std::function<void()>& job);
+	//Espera o ltimo trabalho entregue terminar
+	void wait();
+	//latency em segundos
+	void endFrame(double latency);
+
+	const FramePipelineStats& lastFrame() const { return previous; }
+
+protected:
+	void run();
+
+	bool threaded;
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable wake, done;
+	std::function<void()> job;
+	bool hasJob, stopping;
+	double jobTime;
+
+	FramePipelineStats previous, current;
+};
@@ -0,0 +1,160 @@
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SSE
+#endif
+
+Frustum Frustum::fromMatrix(const glm::mat4& m)
+{
+	//Gribb-Hartmann: combinaes da ltima linha com as outras trs (GLM guarda por coluna)
+	glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	Frustum f;
+	f.planes[0] = row3 + row0; //esquerda
+	f.planes[1] = row3 - row0; //direita
+	f.planes[2] = row3 + row1; //baixo
+	f.planes[3] = row3 - row1; //cima
+	f.planes[4] = row3 + row2; //near
+	f.planes[5] = row3 - row2; //far
+	for (glm::vec4& p : f.planes)
+		p /= glm::length(glm::vec3(p));
+	return f;
+}
+
+FrustumTest Frustum::test(const BoundingBox& box) const
+{
+	FrustumTest result = FrustumTest::Inside;
+	for (const glm::vec4& p : planes)
+	{
+		glm::vec3 normal(p);
+		glm::vec3 positive = glm::mix(box.min, box.max, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+		glm::vec3 negative = glm::mix(box.max, box.min, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+		if (glm::dot(normal, positive) + p.w < 0.0f)
+			return FrustumTest::Outside;
+		if (glm::dot(normal, negative) + p.w < 0.0f)
+			result = FrustumTest::Intersects;
+	}
+	return result;
+}
+
+void FrustumCuller::resize(int n)
+{
+	int padded = (n + LANES - 1) / LANES * LANES;
+	//Os objetos de preenchimento ficam com raio 0 na origem; o resultado deles  ignorado
+	centerX.resize(padded, 0.0f);
+	centerY.resize(padded, 0.0f);
+	centerZ.resize(padded, 0.0f);
+	radius.resize(padded, 0.0f);
+	visible.resize(padded, 0);
+}
+
+int FrustumCuller::add(const BoundingSphere& sphere)
+{
+	resize(count + 1);
+	set(count, sphere);
+	return count++;
+}
+
+void FrustumCuller::set(int id, const BoundingSphere& sphere)
+{
+	centerX[id] = sphere.center.x;
+	centerY[id] = sphere.center.y;
+	centerZ[id] = sphere.center.z;
+	radius[id] = sphere.radius;
+}
+
+void FrustumCuller::clear()
+{
+	count = 0;
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+	visible.clear();
+}
+
+void FrustumCuller::cull(const Frustum& frustum)
+{
+	double start = glfwGetTime();
+
+	//Blocos de LANES objetos; cada job escreve s nos seus
+	jobSystem.parallelFor((int)visible.size() / LANES, MIN_BLOCKS_PER_JOB, [&](int begin, int end) { cullRange(frustum, begin * LANES, end * LANES); });
+
+	unsigned int culled = 0;
+	for (int i = 0; i < count; i++)
+		culled += !visible[i];
+
+	current.tested += count;
+	current.culled += culled;
+	current.time += glfwGetTime() - start;
+}
+
+void FrustumCuller::cullRange(const Frustum& frustum, int begin, int end)
+{
+#if defined(FRUSTUM_CULLER_AVX)
+	for (int i = begin; i < end; i += LANES)
+	{
+		__m256 x = _mm256_loadu_ps(&centerX[i]);
+		__m256 y = _mm256_loadu_ps(&centerY[i]);
+		__m256 z = _mm256_loadu_ps(&centerZ[i]);
+		__m256 negR = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radius[i]));
+		__m256 outside = _mm256_setzero_ps();
+		for (const glm::vec4& p : frustum.planes)
+		{
+			__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(p.x)), _mm256_mul_ps(y, _mm256_set1_ps(p.y))),
+				_mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(p.z)), _mm256_set1_ps(p.w)));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, negR, _CMP_LT_OQ));
+		}
+		int mask = _mm256_movemask_ps(outside);
+		for (int l = 0; l < LANES; l++)
+			visible[i + l] = !((mask >> l) & 1);
+	}
+#elif defined(FRUSTUM_CULLER_SSE)
+	for (int i = begin; i < end; i += LANES)
+	{
+		//Duas metades de 4 objetos por iterao
+		for (int h = 0; h < LANES; h += 4)
+		{
+			__m128 x = _mm_loadu_ps(&centerX[i + h]);
+			__m128 y = _mm_loadu_ps(&centerY[i + h]);
+			__m128 z = _mm_loadu_ps(&centerZ[i + h]);
+			__m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i + h]));
+			__m128 outside = _mm_setzero_ps();
+			for (const glm::vec4& p : frustum.planes)
+			{
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(p.x)), _mm_mul_ps(y, _mm_set1_ps(p.y))),
+					_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(p.z)), _mm_set1_ps(p.w)));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negR));
+			}
+			int mask = _mm_movemask_ps(outside);
+			for (int l = 0; l < 4; l++)
+				visible[i + h + l] = !((mask >> l) & 1);
+		}
+	}
+#else
+	for (int i = begin; i < end; i++)
+	{
+		bool inside = true;
+		for (const glm::vec4& p : frustum.planes)
+			inside = inside && (p.x * centerX[i] + p.y * centerY[i] + p.z * centerZ[i] + p.w >= -radius[i]);
+		visible[i] = inside;
+	}
+#endif
+}
+
+void FrustumCuller::endFrame()
+{
+	previous = current;
+	current = CullingStats{};
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+enum class FrustumTest
+{
+	Outside,
+	Intersects,
+	Inside
+};
+
+// Os 6 planos (ax + by + cz + d >= 0 do lado de dentro) extrados da view-projection
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	static Frustum fromMatrix(const glm::mat4& viewProjection);
+	//Teste com o vrtice positivo/negativo da caixa em cada plano
+	FrustumTest test(const BoundingBox& box) const;
+};
+
+struct CullingStats
+{
+	unsigned int tested;
+	unsigned int culled;
+	double time; //segundos
+};
+
+// Teste esfera x frustum em lote. As esferas ficam em arrays separados (SoA) com
+// tamanho mltiplo de 8, e cada iterao testa 8 objetos: uma operao AVX quando
+// o compilador gera AVX, duas SSE caso contrrio (e um lao escalar fora do x86).
+// Com muitos objetos, os blocos so divididos entre as threads do JobSystem.
+class FrustumCuller
+{
+public:
+	static const int LANES = 8;
+
+	FrustumCuller() : count(0), previous{}, current{} {}
+
+	//Retorna o identificador do objeto (ndice nos arrays)
+	int add(const BoundingSphere& sphere);
+	void set(int id, const BoundingSphere& sphere);
+	void clear();
+	int getCount() const { return count; }
+
+	void cull(const Frustum& frustum);
+	bool isVisible(int id) const { return visible[id] != 0; }
+
+	const CullingStats& lastFrame() const { return previous; }
+	//Fecha as estatsticas do quadro
+	void endFrame();
+
+protected:
+	//Menos blocos que isso por job no compensa o envio
+	static const int MIN_BLOCKS_PER_JOB = 512;
+
+	void resize(int n);
+	void cullRange(const Frustum& frustum, int begin, int end);
+
+	int count;
+	std::vector<float> centerX, centerY, centerZ, radius;
+	std::vector<uint8_t> visible;
+	CullingStats previous, current;
+};
@@ -0,0 +1,103 @@
+#include "GLExtensions.h"
+
+#include <iostream>
+
+#ifdef GLEXT_LOAD_4_0
+PFNGLDRAWELEMENTSINDIRECTPROC glad_glDrawElementsIndirect = NULL;
+#endif
+
+#ifdef GLEXT_LOAD_4_2
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = NULL;
+PFNGLBINDIMAGETEXTUREPROC glad_glBindImageTexture = NULL;
+#endif
+
+#ifdef GLEXT_LOAD_4_3
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = NULL;
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = NULL;
+#endif
+
+#ifdef GLEXT_LOAD_4_4
+PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+#endif
+
+#ifdef GLEXT_LOAD_4_5
+PFNGLCREATEBUFFERSPROC glad_glCreateBuffers = NULL;
+PFNGLNAMEDBUFFERSTORAGEPROC glad_glNamedBufferStorage = NULL;
+PFNGLNAMEDBUFFERSUBDATAPROC glad_glNamedBufferSubData = NULL;
+PFNGLCOPYNAMEDBUFFERSUBDATAPROC glad_glCopyNamedBufferSubData = NULL;
+PFNGLMAPNAMEDBUFFERRANGEPROC glad_glMapNamedBufferRange = NULL;
+PFNGLUNMAPNAMEDBUFFERPROC glad_glUnmapNamedBuffer = NULL;
+PFNGLCREATEVERTEXARRAYSPROC glad_glCreateVertexArrays = NULL;
+PFNGLVERTEXARRAYVERTEXBUFFERPROC glad_glVertexArrayVertexBuffer = NULL;
+PFNGLVERTEXARRAYELEMENTBUFFERPROC glad_glVertexArrayElementBuffer = NULL;
+PFNGLVERTEXARRAYATTRIBFORMATPROC glad_glVertexArrayAttribFormat = NULL;
+PFNGLVERTEXARRAYATTRIBIFORMATPROC glad_glVertexArrayAttribIFormat = NULL;
+PFNGLVERTEXARRAYATTRIBBINDINGPROC glad_glVertexArrayAttribBinding = NULL;
+PFNGLENABLEVERTEXARRAYATTRIBPROC glad_glEnableVertexArrayAttrib = NULL;
+PFNGLVERTEXARRAYBINDINGDIVISORPROC glad_glVertexArrayBindingDivisor = NULL;
+PFNGLCREATETEXTURESPROC glad_glCreateTextures = NULL;
+PFNGLTEXTURESTORAGE2DPROC glad_glTextureStorage2D = NULL;
+PFNGLTEXTURESUBIMAGE2DPROC glad_glTextureSubImage2D = NULL;
+PFNGLTEXTUREPARAMETERIPROC glad_glTextureParameteri = NULL;
+PFNGLGENERATETEXTUREMIPMAPPROC glad_glGenerateTextureMipmap = NULL;
+PFNGLBINDTEXTUREUNITPROC glad_glBindTextureUnit = NULL;
+PFNGLCREATEFRAMEBUFFERSPROC glad_glCreateFramebuffers = NULL;
+PFNGLNAMEDFRAMEBUFFERTEXTUREPROC glad_glNamedFramebufferTexture = NULL;
+PFNGLBLITNAMEDFRAMEBUFFERPROC glad_glBlitNamedFramebuffer = NULL;
+PFNGLGETNAMEDBUFFERSUBDATAPROC glad_glGetNamedBufferSubData = NULL;
+PFNGLCREATEQUERIESPROC glad_glCreateQueries = NULL;
+PFNGLCHECKNAMEDFRAMEBUFFERSTATUSPROC glad_glCheckNamedFramebufferStatus = NULL;
+#endif
+
+//Igual ao glad.c, mas avisa quando o driver no exporta a funo
+#define GLEXT_LOAD(type, name) \
+	glad_##name = (type)load(#name); \
+	if (!glad_##name) { std::cout << "ERROR::GL::MISSING_ENTRY_POINT " #name << std::endl; ok = false; }
+
+bool loadGLExtensions(GLADloadproc load)
+{
+	bool ok = true;
+#ifdef GLEXT_LOAD_4_0
+	GLEXT_LOAD(PFNGLDRAWELEMENTSINDIRECTPROC, glDrawElementsIndirect);
+#endif
+#ifdef GLEXT_LOAD_4_2
+	GLEXT_LOAD(PFNGLMEMORYBARRIERPROC, glMemoryBarrier);
+	GLEXT_LOAD(PFNGLBINDIMAGETEXTUREPROC, glBindImageTexture);
+#endif
+#ifdef GLEXT_LOAD_4_3
+	GLEXT_LOAD(PFNGLMULTIDRAWELEMENTSINDIRECTPROC, glMultiDrawElementsIndirect);
+	GLEXT_LOAD(PFNGLDISPATCHCOMPUTEPROC, glDispatchCompute);
+#endif
+#ifdef GLEXT_LOAD_4_4
+	GLEXT_LOAD(PFNGLBUFFERSTORAGEPROC, glBufferStorage);
+#endif
+#ifdef GLEXT_LOAD_4_5
+	GLEXT_LOAD(PFNGLCREATEBUFFERSPROC, glCreateBuffers);
+	GLEXT_LOAD(PFNGLNAMEDBUFFERSTORAGEPROC, glNamedBufferStorage);
+	GLEXT_LOAD(PFNGLNAMEDBUFFERSUBDATAPROC, glNamedBufferSubData);
+	GLEXT_LOAD(PFNGLCOPYNAMEDBUFFERSUBDATAPROC, glCopyNamedBufferSubData);
+	GLEXT_LOAD(PFNGLMAPNAMEDBUFFERRANGEPROC, glMapNamedBufferRange);
+	GLEXT_LOAD(PFNGLUNMAPNAMEDBUFFERPROC, glUnmapNamedBuffer);
+	GLEXT_LOAD(PFNGLCREATEVERTEXARRAYSPROC, glCreateVertexArrays);
+	GLEXT_LOAD(PFNGLVERTEXARRAYVERTEXBUFFERPROC, glVertexArrayVertexBuffer);
+	GLEXT_LOAD(PFNGLVERTEXARRAYELEMENTBUFFERPROC, glVertexArrayElementBuffer);
+	GLEXT_LOAD(PFNGLVERTEXARRAYATTRIBFORMATPROC, glVertexArrayAttribFormat);
+	GLEXT_LOAD(PFNGLVERTEXARRAYATTRIBIFORMATPROC, glVertexArrayAttribIFormat);
+	GLEXT_LOAD(PFNGLVERTEXARRAYATTRIBBINDINGPROC, glVertexArrayAttribBinding);
+	GLEXT_LOAD(PFNGLENABLEVERTEXARRAYATTRIBPROC, glEnableVertexArrayAttrib);
+	GLEXT_LOAD(PFNGLVERTEXARRAYBINDINGDIVISORPROC, glVertexArrayBindingDivisor);
+	GLEXT_LOAD(PFNGLCREATETEXTURESPROC, glCreateTextures);
+	GLEXT_LOAD(PFNGLTEXTURESTORAGE2DPROC, glTextureStorage2D);
+	GLEXT_LOAD(PFNGLTEXTURESUBIMAGE2DPROC, glTextureSubImage2D);
+	GLEXT_LOAD(PFNGLTEXTUREPARAMETERIPROC, glTextureParameteri);
+	GLEXT_LOAD(PFNGLGENERATETEXTUREMIPMAPPROC, glGenerateTextureMipmap);
+	GLEXT_LOAD(PFNGLBINDTEXTUREUNITPROC, glBindTextureUnit);
+	GLEXT_LOAD(PFNGLCREATEFRAMEBUFFERSPROC, glCreateFramebuffers);
+	GLEXT_LOAD(PFNGLNAMEDFRAMEBUFFERTEXTUREPROC, glNamedFramebufferTexture);
+	GLEXT_LOAD(PFNGLBLITNAMEDFRAMEBUFFERPROC, glBlitNamedFramebuffer);
+	GLEXT_LOAD(PFNGLGETNAMEDBUFFERSUBDATAPROC, glGetNamedBufferSubData);
+	GLEXT_LOAD(PFNGLCREATEQUERIESPROC, glCreateQueries);
+	GLEXT_LOAD(PFNGLCHECKNAMEDFRAMEBUFFERSTATUSPROC, glCheckNamedFramebufferStatus);
+#endif
+	return ok;
+}
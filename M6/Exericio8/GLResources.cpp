@@ -0,0 +1,117 @@
+#include "GLResources.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Buffer::initialize(GLsizeiptr size, const void* data, GLbitfield flags)
+{
+	destroy();
+	this->size = size;
+	this->flags = flags;
+	glCreateBuffers(1, &ID);
+	//glNamedBufferStorage no aceita tamanho 0
+	glNamedBufferStorage(ID, size > 0 ? size : 1, data, flags);
+}
+
+void Buffer::update(GLintptr offset, GLsizeiptr size, const void* data)
+{
+	glNamedBufferSubData(ID, offset, size, data);
+}
+
+void Buffer::destroy()
+{
+	if (ID == 0)
+		return;
+	glDeleteBuffers(1, &ID);
+	glState.forgetBuffer(ID);
+	ID = 0;
+	size = 0;
+}
+
+void VertexArray::initialize()
+{
+	destroy();
+	glCreateVertexArrays(1, &ID);
+}
+
+void VertexArray::setAttribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint relativeOffset, GLboolean normalized)
+{
+	glVertexArrayAttribFormat(ID, location, size, type, normalized, relativeOffset);
+	glVertexArrayAttribBinding(ID, location, binding);
+	glEnableVertexArrayAttrib(ID, location);
+}
+
+void VertexArray::setIntAttribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint relativeOffset)
+{
+	glVertexArrayAttribIFormat(ID, location, size, type, relativeOffset);
+	glVertexArrayAttribBinding(ID, location, binding);
+	glEnableVertexArrayAttrib(ID, location);
+}
+
+void VertexArray::setVertexBuffer(GLuint binding, const Buffer& buffer, GLintptr offset, GLsizei stride)
+{
+	glVertexArrayVertexBuffer(ID, binding, buffer.ID, offset, stride);
+}
+
+void VertexArray::setElementBuffer(const Buffer& buffer)
+{
+	glVertexArrayElementBuffer(ID, buffer.ID);
+}
+
+void VertexArray::setDivisor(GLuint binding, GLuint divisor)
+{
+	glVertexArrayBindingDivisor(ID, binding, divisor);
+}
+
+void VertexArray::destroy()
+{
+	if (ID == 0)
+		return;
+	glDeleteVertexArrays(1, &ID);
+	glState.forgetVertexArray(ID);
+	ID = 0;
+}
+
+GLuint createTexture2D(int width, int height, int nrChannels, const unsigned char* data)
+{
+	if (!data)
+		return 0;
+
+	GLuint texID;
+	glCreateTextures(GL_TEXTURE_2D, 1, &texID);
+
+	glTextureParameteri(texID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(texID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTextureParameteri(texID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(texID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	//Nmero de nveis da cadeia completa de mipmaps
+	GLsizei levels = 1 + (GLsizei)std::floor(std::log2((float)std::max(width, height)));
+
+	if (nrChannels == 3)
+	{
+		glTextureStorage2D(texID, levels, GL_RGB8, width, height);
+		//Linhas RGB nem sempre so mltiplas de 4 bytes
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTextureSubImage2D(texID, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else
+	{
+		glTextureStorage2D(texID, levels, GL_RGBA8, width, height);
+		glTextureSubImage2D(texID, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	}
+	glGenerateTextureMipmap(texID);
+
+	return texID;
+}
+
+void destroyTexture(GLuint texture)
+{
+	if (texture == 0)
+		return;
+	glDeleteTextures(1, &texture);
+	glState.forgetTexture(texture);
+}
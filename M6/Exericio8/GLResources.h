@@ -0,0 +1,52 @@
+// Recursos da OpenGL criados com Direct State Access (4.5): nada aqui
+// depende do que estiver vinculado no contexto. Os objetos guardam o
+// prprio identificador e so liberados com destroy(), antes de
+// glfwTerminate() - igual ao resto do projeto, no h destrutor que chame a GL.
+
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+// Buffer com armazenamento imutvel (glNamedBufferStorage): o tamanho 
+// fixado na criao; o contedo s pode ser trocado via update() se
+// GL_DYNAMIC_STORAGE_BIT estiver nas flags
+class Buffer
+{
+public:
+	Buffer() : ID(0), size(0), flags(0) {}
+	void initialize(GLsizeiptr size, const void* data, GLbitfield flags = 0);
+	void update(GLintptr offset, GLsizeiptr size, const void* data);
+	void destroy();
+	bool isValid() const { return ID != 0; }
+
+	GLuint ID;
+	GLsizeiptr size;
+	GLbitfield flags;
+};
+
+// VAO configurado pelo formato dos atributos + pontos de ligao (binding
+// points), sem glBindBuffer/glVertexAttribPointer
+class VertexArray
+{
+public:
+	VertexArray() : ID(0) {}
+	void initialize();
+	//Formato de um atributo float (location) e de qual binding ele l
+	void setAttribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint relativeOffset, GLboolean normalized = GL_FALSE);
+	//Atributo inteiro (glVertexArrayAttribIFormat)
+	void setIntAttribute(GLuint location, GLuint binding, GLint size, GLenum type, GLuint relativeOffset);
+	void setVertexBuffer(GLuint binding, const Buffer& buffer, GLintptr offset, GLsizei stride);
+	void setElementBuffer(const Buffer& buffer);
+	void setDivisor(GLuint binding, GLuint divisor);
+	void destroy();
+
+	GLuint ID;
+};
+
+// Textura 2D com armazenamento imutvel e mipmaps gerados a partir da imagem
+// (nrChannels 3 = RGB, 4 = RGBA). Retorna 0 se data for NULL.
+GLuint createTexture2D(int width, int height, int nrChannels, const unsigned char* data);
+void destroyTexture(GLuint texture);
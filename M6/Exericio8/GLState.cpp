@@ -0,0 +1,171 @@
+#include "GLState.h"
+
+GLStateCache glState;
+
+bool GLStateCache::hit(bool redundant)
+{
+	if (redundant)
+		current.skipped++;
+	else
+		current.issued++;
+	return redundant;
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (hit(this->program == program))
+		return;
+	this->program = program;
+	glUseProgram(program);
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+	if (hit(this->vao == vao))
+		return;
+	this->vao = vao;
+	glBindVertexArray(vao);
+
+	//O GL_ELEMENT_ARRAY_BUFFER faz parte do estado do VAO
+	for (int i = 0; i < nBufferTargets; i++)
+	{
+		if (bufferTargets[i] == GL_ELEMENT_ARRAY_BUFFER)
+			buffers[i] = UNKNOWN;
+	}
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	int slot = -1;
+	for (int i = 0; i < nBufferTargets; i++)
+	{
+		if (bufferTargets[i] == target)
+		{
+			slot = i;
+			break;
+		}
+	}
+	if (slot == -1 && nBufferTargets < MAX_BUFFER_TARGETS)
+	{
+		slot = nBufferTargets++;
+		bufferTargets[slot] = target;
+		buffers[slot] = UNKNOWN;
+	}
+
+	if (slot != -1 && hit(buffers[slot] == buffer))
+		return;
+	if (slot != -1)
+		buffers[slot] = buffer;
+	else
+		current.issued++;
+	glBindBuffer(target, buffer);
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+	if (unit >= MAX_TEXTURE_UNITS)
+	{
+		current.issued++;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(target, texture);
+		activeUnit = unit;
+		return;
+	}
+
+	if (hit(textureTargets[unit] == target && textures[unit] == texture))
+		return;
+
+	if (activeUnit != unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		activeUnit = unit;
+	}
+	glBindTexture(target, texture);
+	textureTargets[unit] = target;
+	textures[unit] = texture;
+}
+
+void GLStateCache::setCap(GLenum cap, bool enabled)
+{
+	int slot = -1;
+	for (int i = 0; i < nCaps; i++)
+	{
+		if (caps[i] == cap)
+		{
+			slot = i;
+			break;
+		}
+	}
+	if (slot == -1 && nCaps < MAX_CAPS)
+	{
+		slot = nCaps++;
+		caps[slot] = cap;
+		capStates[slot] = -1;
+	}
+
+	if (slot != -1 && hit(capStates[slot] == (enabled ? 1 : 0)))
+		return;
+	if (slot != -1)
+		capStates[slot] = enabled ? 1 : 0;
+	else
+		current.issued++;
+
+	if (enabled)
+		glEnable(cap);
+	else
+		glDisable(cap);
+}
+
+void GLStateCache::enable(GLenum cap)
+{
+	setCap(cap, true);
+}
+
+void GLStateCache::disable(GLenum cap)
+{
+	setCap(cap, false);
+}
+
+void GLStateCache::forgetVertexArray(GLuint vao)
+{
+	if (this->vao == vao)
+		this->vao = 0;
+}
+
+void GLStateCache::forgetBuffer(GLuint buffer)
+{
+	for (int i = 0; i < nBufferTargets; i++)
+	{
+		if (buffers[i] == buffer)
+			buffers[i] = 0;
+	}
+}
+
+void GLStateCache::forgetTexture(GLuint texture)
+{
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		if (textures[i] == texture)
+			textures[i] = 0;
+	}
+}
+
+void GLStateCache::invalidate()
+{
+	program = UNKNOWN;
+	vao = UNKNOWN;
+	activeUnit = UNKNOWN;
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		textureTargets[i] = 0;
+		textures[i] = UNKNOWN;
+	}
+	nBufferTargets = 0;
+	nCaps = 0;
+}
+
+void GLStateCache::beginFrame()
+{
+	previous = current;
+	current = { 0, 0 };
+}
@@ -0,0 +1,74 @@
+// Cache do estado da OpenGL: lembra programa, VAO, texturas por unidade,
+// buffers por alvo e glEnable/glDisable, e s repassa ao driver o que mudou
+
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+struct GLStateStats
+{
+	unsigned int issued;  //Chamadas que chegaram  OpenGL
+	unsigned int skipped; //Chamadas redundantes descartadas pelo cache
+};
+
+class GLStateCache
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 16;
+	static const int MAX_BUFFER_TARGETS = 12;
+	static const int MAX_CAPS = 16;
+
+	GLStateCache() : current{ 0, 0 }, previous{ 0, 0 } { invalidate(); }
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vao);
+	void bindBuffer(GLenum target, GLuint buffer);
+	void bindTexture(GLuint unit, GLenum target, GLuint texture);
+	void enable(GLenum cap);
+	void disable(GLenum cap);
+
+	//Avisa o cache que um objeto foi destrudo (a OpenGL desvincula sozinha)
+	void forgetVertexArray(GLuint vao);
+	void forgetBuffer(GLuint buffer);
+	void forgetTexture(GLuint texture);
+
+	//Esquece tudo - usar depois de cdigo que altera o estado sem passar pelo cache
+	void invalidate();
+
+	//Fecha as estatsticas do quadro anterior e zera os contadores
+	void beginFrame();
+	const GLStateStats& lastFrame() const { return previous; }
+	const GLStateStats& currentFrame() const { return current; }
+
+	GLuint currentProgram() const { return program; }
+	GLuint currentVertexArray() const { return vao; }
+
+protected:
+	//Valor usado para "desconhecido", diferente de qualquer nome vlido
+	static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+	void setCap(GLenum cap, bool enabled);
+	bool hit(bool redundant);
+
+	GLuint program;
+	GLuint vao;
+	GLuint activeUnit;
+
+	GLenum textureTargets[MAX_TEXTURE_UNITS];
+	GLuint textures[MAX_TEXTURE_UNITS];
+
+	GLenum bufferTargets[MAX_BUFFER_TARGETS];
+	GLuint buffers[MAX_BUFFER_TARGETS];
+	int nBufferTargets;
+
+	GLenum caps[MAX_CAPS];
+	signed char capStates[MAX_CAPS]; //-1 desconhecido, 0 desabilitado, 1 habilitado
+	int nCaps;
+
+	GLStateStats current;
+	GLStateStats previous;
+};
+
+//Instncia nica - existe um s contexto OpenGL na aplicao
+extern GLStateCache glState;
@@ -0,0 +1,280 @@
+#include "GeometryArena.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+void RangeAllocator::initialize(GLuint capacity)
+{
+	this->capacity = capacity;
+	reset(0);
+}
+
+int RangeAllocator::allocate(GLuint count)
+{
+	if (count == 0)
+		return 0;
+	for (size_t i = 0; i < freeRanges.size(); i++)
+	{
+		if (freeRanges[i].count < count)
+			continue;
+		GLuint offset = freeRanges[i].offset;
+		freeRanges[i].offset += count;
+		freeRanges[i].count -= count;
+		if (freeRanges[i].count == 0)
+			freeRanges.erase(freeRanges.begin() + i);
+		freeCount -= count;
+		return (int)offset;
+	}
+	return -1;
+}
+
+void RangeAllocator::free(GLuint offset, GLuint count)
+{
+	if (count == 0)
+		return;
+
+	//Insere mantendo a ordem por offset e junta com os vizinhos encostados
+	size_t i = 0;
+	while (i < freeRanges.size() && freeRanges[i].offset < offset)
+		i++;
+	freeRanges.insert(freeRanges.begin() + i, Range{ offset, count });
+	freeCount += count;
+
+	if (i + 1 < freeRanges.size() && freeRanges[i].offset + freeRanges[i].count == freeRanges[i + 1].offset)
+	{
+		freeRanges[i].count += freeRanges[i + 1].count;
+		freeRanges.erase(freeRanges.begin() + i + 1);
+	}
+	if (i > 0 && freeRanges[i - 1].offset + freeRanges[i - 1].count == freeRanges[i].offset)
+	{
+		freeRanges[i - 1].count += freeRanges[i].count;
+		freeRanges.erase(freeRanges.begin() + i);
+	}
+}
+
+void RangeAllocator::reset(GLuint used)
+{
+	freeRanges.clear();
+	if (used < capacity)
+		freeRanges.push_back(Range{ used, capacity - used });
+	freeCount = capacity - used;
+}
+
+void GeometryArena::initialize(GLsizei vertexStride, GLuint maxVertices, GLuint maxIndices)
+{
+	this->vertexStride = vertexStride;
+	vertexRanges.initialize(maxVertices);
+	indexRanges.initialize(maxIndices);
+	allocations.clear();
+	freeSlots.clear();
+	compactions = 0;
+
+	createBuffers(vertexBuffer, indexBuffer);
+	VAO.initialize();
+	attachBuffers();
+}
+
+void GeometryArena::destroy()
+{
+	VAO.destroy();
+	vertexBuffer.destroy();
+	indexBuffer.destroy();
+	allocations.clear();
+	freeSlots.clear();
+}
+
+void GeometryArena::createBuffers(Buffer& vertices, Buffer& indices)
+{
+	//Armazenamento imutvel; DYNAMIC_STORAGE permite glNamedBufferSubData nas sub-alocaes
+	vertices.initialize((GLsizeiptr)vertexRanges.getCapacity() * vertexStride, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	indices.initialize((GLsizeiptr)indexRanges.getCapacity() * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+}
+
+void GeometryArena::attachBuffers()
+{
+	VAO.setVertexBuffer(0, vertexBuffer, 0, vertexStride);
+	if (indexRanges.getCapacity() > 0)
+		VAO.setElementBuffer(indexBuffer);
+}
+
+int GeometryArena::allocate(const void* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount)
+{
+	int baseVertex = vertexRanges.allocate(vertexCount);
+	int firstIndex = indexRanges.allocate(indexCount);
+
+	//Espao total suficiente, mas fragmentado: compacta e tenta de novo.
+	//A metade que conseguiu espao  devolvida antes, para entrar na contagem livre
+	if (baseVertex < 0 || firstIndex < 0)
+	{
+		if (baseVertex >= 0)
+			vertexRanges.free(baseVertex, vertexCount);
+		if (firstIndex >= 0)
+			indexRanges.free(firstIndex, indexCount);
+		baseVertex = firstIndex = -1;
+		if (vertexRanges.getFreeCount() >= vertexCount && indexRanges.getFreeCount() >= indexCount)
+		{
+			compact();
+			baseVertex = vertexRanges.allocate(vertexCount);
+			firstIndex = indexRanges.allocate(indexCount);
+		}
+	}
+
+	if (baseVertex < 0 || firstIndex < 0)
+	{
+		if (baseVertex >= 0)
+			vertexRanges.free(baseVertex, vertexCount);
+		if (firstIndex >= 0)
+			indexRanges.free(firstIndex, indexCount);
+		std::cout << "ERROR::GEOMETRY_ARENA::OUT_OF_MEMORY (" << vertexCount << " vertices, " << indexCount << " indices)" << std::endl;
+		return -1;
+	}
+
+	vertexBuffer.update((GLintptr)baseVertex * vertexStride, (GLsizeiptr)vertexCount * vertexStride, vertices);
+	if (indexCount > 0)
+		indexBuffer.update((GLintptr)firstIndex * sizeof(GLuint), (GLsizeiptr)indexCount * sizeof(GLuint), indices);
+
+	ArenaAllocation allocation = { baseVertex, vertexCount, (GLuint)firstIndex, indexCount, true };
+	if (!freeSlots.empty())
+	{
+		int slot = freeSlots.back();
+		freeSlots.pop_back();
+		allocations[slot] = allocation;
+		return slot;
+	}
+	allocations.push_back(allocation);
+	return (int)allocations.size() - 1;
+}
+
+void GeometryArena::free(int allocation)
+{
+	ArenaAllocation& a = allocations[allocation];
+	if (!a.alive)
+		return;
+	vertexRanges.free(a.baseVertex, a.vertexCount);
+	indexRanges.free(a.firstIndex, a.indexCount);
+	a.alive = false;
+	freeSlots.push_back(allocation);
+}
+
+void GeometryArena::updateVertices(int allocation, const void* vertices)
+{
+	const ArenaAllocation& a = allocations[allocation];
+	vertexBuffer.update((GLintptr)a.baseVertex * vertexStride, (GLsizeiptr)a.vertexCount * vertexStride, vertices);
+}
+
+void GeometryArena::compact()
+{
+	//Os buffers so imutveis: cria outros do mesmo tamanho e copia as alocaes vivas
+	//em sequncia (glCopyNamedBufferSubData no permite origem e destino sobrepostos)
+	Buffer newVertices, newIndices;
+	createBuffers(newVertices, newIndices);
+
+	std::vector<int> order;
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		if (allocations[i].alive)
+			order.push_back((int)i);
+	}
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return allocations[a].baseVertex < allocations[b].baseVertex; });
+
+	GLuint nextVertex = 0, nextIndex = 0;
+	for (int i : order)
+	{
+		ArenaAllocation& a = allocations[i];
+		glCopyNamedBufferSubData(vertexBuffer.ID, newVertices.ID, (GLintptr)a.baseVertex * vertexStride,
+			(GLintptr)nextVertex * vertexStride, (GLsizeiptr)a.vertexCount * vertexStride);
+		if (a.indexCount > 0)
+		{
+			glCopyNamedBufferSubData(indexBuffer.ID, newIndices.ID, (GLintptr)a.firstIndex * sizeof(GLuint),
+				(GLintptr)nextIndex * sizeof(GLuint), (GLsizeiptr)a.indexCount * sizeof(GLuint));
+		}
+		//Os ndices so relativos ao baseVertex, ento no precisam ser reescritos
+		a.baseVertex = nextVertex;
+		a.firstIndex = nextIndex;
+		nextVertex += a.vertexCount;
+		nextIndex += a.indexCount;
+	}
+
+	vertexBuffer.destroy();
+	indexBuffer.destroy();
+	vertexBuffer = newVertices;
+	indexBuffer = newIndices;
+	vertexRanges.reset(nextVertex);
+	indexRanges.reset(nextIndex);
+
+	//O VAO continua o mesmo, s troca os buffers ligados a ele
+	attachBuffers();
+	compactions++;
+}
+
+void GeometryArena::draw(int allocation, GLenum mode) const
+{
+	const ArenaAllocation& a = allocations[allocation];
+	glState.bindVertexArray(VAO.ID);
+	if (a.indexCount > 0)
+		glDrawElementsBaseVertex(mode, a.indexCount, GL_UNSIGNED_INT, (void*)((size_t)a.firstIndex * sizeof(GLuint)), a.baseVertex);
+	else
+		glDrawArrays(mode, a.baseVertex, a.vertexCount);
+}
+
+void setupMeshVertexFormat(GeometryArena& arena)
+{
+	VertexArray& VAO = arena.getVAO();
+	VAO.setAttribute(0, 0, 3, GL_FLOAT, offsetof(MeshVertex, position));
+	VAO.setAttribute(1, 0, 2, GL_FLOAT, offsetof(MeshVertex, texCoord));
+	VAO.setAttribute(2, 0, 3, GL_FLOAT, offsetof(MeshVertex, normal));
+}
+
+namespace
+{
+	struct MeshVertexHash
+	{
+		size_t operator()(const MeshVertex& v) const
+		{
+			const uint32_t* words = reinterpret_cast<const uint32_t*>(&v);
+			size_t hash = 2166136261u;
+			for (size_t i = 0; i < sizeof(MeshVertex) / sizeof(uint32_t); i++)
+				hash = (hash ^ words[i]) * 16777619u;
+			return hash;
+		}
+	};
+
+	struct MeshVertexEqual
+	{
+		bool operator()(const MeshVertex& a, const MeshVertex& b) const
+		{
+			return memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+		}
+	};
+}
+
+void buildIndexedMesh(const std::vector<GLfloat>& positions, const std::vector<GLfloat>& textureCoords, const std::vector<GLfloat>& normals,
+	std::vector<MeshVertex>& vertices, std::vector<GLuint>& indices)
+{
+	std::unordered_map<MeshVertex, GLuint, MeshVertexHash, MeshVertexEqual> unique;
+	size_t nVertices = positions.size() / 3;
+	vertices.clear();
+	indices.clear();
+	indices.reserve(nVertices);
+
+	for (size_t i = 0; i < nVertices; i++)
+	{
+		MeshVertex v;
+		v.position = glm::vec3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]);
+		v.texCoord = 2 * i + 1 < textureCoords.size() ? glm::vec2(textureCoords[2 * i], textureCoords[2 * i + 1]) : glm::vec2(0.0f);
+		v.normal = 3 * i + 2 < normals.size() ? glm::vec3(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]) : glm::vec3(0.0f);
+
+		auto it = unique.find(v);
+		if (it == unique.end())
+		{
+			it = unique.emplace(v, (GLuint)vertices.size()).first;
+			vertices.push_back(v);
+		}
+		indices.push_back(it->second);
+	}
+}
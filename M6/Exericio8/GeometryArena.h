@@ -0,0 +1,110 @@
+// Arena de geometria: um nico vertex buffer e um nico index buffer
+// imutveis, sub-alocados entre todas as malhas de um mesmo formato de
+// vrtice. Cada malha guarda s o baseVertex e o firstIndex, ento todas
+// so desenhadas com o mesmo VAO.
+
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "GLResources.h"
+
+// Alocador de intervalos [offset, offset + count) com lista de livres
+// ordenada (first-fit) e juno de vizinhos ao liberar
+class RangeAllocator
+{
+public:
+	void initialize(GLuint capacity);
+	//Retorna o offset ou -1 se no houver um intervalo contnuo livre do tamanho pedido
+	int allocate(GLuint count);
+	void free(GLuint offset, GLuint count);
+	//Marca [0, used) como ocupado e o resto como livre (usado depois da compactao)
+	void reset(GLuint used);
+	GLuint getCapacity() const { return capacity; }
+	GLuint getFreeCount() const { return freeCount; }
+	int getFragmentCount() const { return (int)freeRanges.size(); }
+
+protected:
+	struct Range
+	{
+		GLuint offset;
+		GLuint count;
+	};
+	std::vector<Range> freeRanges;
+	GLuint capacity;
+	GLuint freeCount;
+};
+
+// Vrtice intercalado do formato das malhas (hello.vs: locations 0, 1 e 2)
+struct MeshVertex
+{
+	glm::vec3 position;
+	glm::vec2 texCoord;
+	glm::vec3 normal;
+};
+
+// Uma malha dentro da arena
+struct ArenaAllocation
+{
+	GLint baseVertex;
+	GLuint vertexCount;
+	GLuint firstIndex;
+	GLuint indexCount; //0 = malha sem ndices (desenhada com glDrawArrays)
+	bool alive;
+};
+
+class GeometryArena
+{
+public:
+	GeometryArena() : vertexStride(0), compactions(0) {}
+	void initialize(GLsizei vertexStride, GLuint maxVertices, GLuint maxIndices);
+	void destroy();
+
+	//Copia os vrtices/ndices para a arena e retorna o identificador da alocao (-1 se no couber).
+	//Os ndices so relativos ao primeiro vrtice da prpria malha.
+	int allocate(const void* vertices, GLuint vertexCount, const GLuint* indices = nullptr, GLuint indexCount = 0);
+	void free(int allocation);
+	//Reescreve os vrtices de uma alocao existente (mesmo nmero de vrtices)
+	void updateVertices(int allocation, const void* vertices);
+
+	//Move as alocaes vivas para o comeo dos buffers, eliminando os buracos.
+	//Os identificadores continuam vlidos; s baseVertex/firstIndex mudam.
+	void compact();
+
+	const ArenaAllocation& get(int allocation) const { return allocations[allocation]; }
+	void draw(int allocation, GLenum mode = GL_TRIANGLES) const;
+
+	//O VAO j tem vertex buffer (binding 0) e index buffer; falta s o formato dos atributos
+	VertexArray& getVAO() { return VAO; }
+	GLuint getVertexBuffer() const { return vertexBuffer.ID; }
+	GLuint getIndexBuffer() const { return indexBuffer.ID; }
+	GLsizei getVertexStride() const { return vertexStride; }
+	int getCompactionCount() const { return compactions; }
+	GLuint getFreeVertices() const { return vertexRanges.getFreeCount(); }
+	GLuint getFreeIndices() const { return indexRanges.getFreeCount(); }
+
+protected:
+	void createBuffers(Buffer& vertices, Buffer& indices);
+	void attachBuffers();
+
+	GLsizei vertexStride;
+	Buffer vertexBuffer;
+	Buffer indexBuffer;
+	VertexArray VAO;
+	RangeAllocator vertexRanges;
+	RangeAllocator indexRanges;
+	std::vector<ArenaAllocation> allocations;
+	std::vector<int> freeSlots;
+	int compactions;
+};
+
+// Configura o VAO da arena para o formato MeshVertex
+void setupMeshVertexFormat(GeometryArena& arena);
+
+// Converte os arrays separados do loadOBJ (posio/textura/normal por vrtice
+// de tringulo) em vrtices intercalados sem repetio + ndices
+void buildIndexedMesh(const std::vector<GLfloat>& positions, const std::vector<GLfloat>& textureCoords, const std::vector<GLfloat>& normals,
+	std::vector<MeshVertex>& vertices, std::vector<GLuint>& indices);
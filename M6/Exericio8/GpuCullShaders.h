@@ -0,0 +1,40 @@
+// Interface esperada dos compute shaders cull.comp e depth_pyramid.comp,
+// conferida logo depois do link (mesmo esquema do HelloShader.h)
+
+#pragma once
+
+#include "UniformReflection.h"
+
+namespace CullShader
+{
+	constexpr UniformDecl<int> objectCount("objectCount");
+	//Array de 6 planos: enviado com glUniform4fv na location do primeiro
+	constexpr UniformDecl<glm::vec4> frustumPlanes("frustumPlanes");
+	constexpr UniformDecl<glm::mat4> viewProjection("viewProjection");
+	constexpr UniformDecl<bool> occlusion("occlusion");
+	constexpr UniformDecl<int> depthPyramid("depthPyramid");
+	constexpr UniformDecl<glm::vec2> pyramidSize("pyramidSize");
+
+	constexpr GLuint OBJECTS_BINDING = 2;
+	constexpr GLuint VISIBLE_BINDING = 3;
+	constexpr GLuint COMMAND_BINDING = 4;
+	constexpr GLuint WORKGROUP_SIZE = 64;
+
+	constexpr UniformSignature uniforms[] = {
+		objectCount, frustumPlanes, viewProjection,
+		occlusion, depthPyramid, pyramidSize
+	};
+}
+
+namespace DepthPyramidShader
+{
+	constexpr UniformDecl<int> source("source");
+	constexpr UniformDecl<int> sourceLevel("sourceLevel");
+	constexpr UniformDecl<int> destination("destination");
+
+	constexpr GLuint WORKGROUP_SIZE = 8;
+
+	constexpr UniformSignature uniforms[] = {
+		source, sourceLevel, destination
+	};
+}
@@ -0,0 +1,117 @@
+#include "GpuCuller.h"
+#include "GpuCullShaders.h"
+#include "Mesh.h"
+#include "DrawBatcher.h"
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cstddef>
+
+void GpuCuller::initialize(Shader* cullShader, Shader* drawShader, GeometryArena* arena, int allocation, int maxObjects, GLuint textureID)
+{
+	this->cullShader = cullShader;
+	this->drawShader = drawShader;
+	this->arena = arena;
+	this->allocation = allocation;
+	this->maxObjects = maxObjects;
+	this->textureID = textureID;
+	objectCount = 0;
+
+	objectBuffer.initialize((GLsizeiptr)maxObjects * sizeof(GpuObject), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	visibleBuffer.initialize((GLsizeiptr)maxObjects * sizeof(glm::mat4), nullptr);
+	commandBuffer.initialize(sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	//Formato da arena (locations 0-2, binding 0) + matriz da instncia visvel no binding 1
+	vao.initialize();
+	vao.setAttribute(0, 0, 3, GL_FLOAT, offsetof(MeshVertex, position));
+	vao.setAttribute(1, 0, 2, GL_FLOAT, offsetof(MeshVertex, texCoord));
+	vao.setAttribute(2, 0, 3, GL_FLOAT, offsetof(MeshVertex, normal));
+	for (GLuint column = 0; column < 4; column++)
+		vao.setAttribute(3 + column, INSTANCE_BINDING, 4, GL_FLOAT, column * sizeof(glm::vec4));
+	vao.setVertexBuffer(INSTANCE_BINDING, visibleBuffer, 0, sizeof(glm::mat4));
+	vao.setDivisor(INSTANCE_BINDING, 1);
+
+	attachedVertexBuffer = attachedIndexBuffer = 0;
+	attachArenaBuffers();
+}
+
+void GpuCuller::destroy()
+{
+	vao.destroy();
+	objectBuffer.destroy();
+	visibleBuffer.destroy();
+	commandBuffer.destroy();
+	objectCount = 0;
+}
+
+void GpuCuller::attachArenaBuffers()
+{
+	if (attachedVertexBuffer == arena->getVertexBuffer() && attachedIndexBuffer == arena->getIndexBuffer())
+		return;
+	attachedVertexBuffer = arena->getVertexBuffer();
+	attachedIndexBuffer = arena->getIndexBuffer();
+	glVertexArrayVertexBuffer(vao.ID, 0, attachedVertexBuffer, 0, arena->getVertexStride());
+	glVertexArrayElementBuffer(vao.ID, attachedIndexBuffer);
+}
+
+void GpuCuller::setObjects(const std::vector<glm::mat4>& models, const BoundingSphere& localSphere)
+{
+	objectCount = (int)std::min(models.size(), (size_t)maxObjects);
+	std::vector<GpuObject> objects(objectCount);
+	for (int i = 0; i < objectCount; i++)
+		objects[i] = GpuObject{ models[i], glm::vec4(localSphere.center, localSphere.radius) };
+	if (objectCount > 0)
+		objectBuffer.update(0, objectCount * sizeof(GpuObject), objects.data());
+}
+
+void GpuCuller::cull(const glm::mat4& viewProjection, const DepthPyramid* pyramid)
+{
+	//O contador de instncias volta a zero; o resto do comando vem da alocao na arena
+	const ArenaAllocation& a = arena->get(allocation);
+	DrawElementsIndirectCommand command = { a.indexCount, 0, a.firstIndex, a.baseVertex, 0 };
+	commandBuffer.update(0, sizeof(command), &command);
+
+	Frustum frustum = Frustum::fromMatrix(viewProjection);
+	bool occlusion = pyramid && pyramid->isReady();
+
+	cullShader->Use();
+	cullShader->set(CullShader::objectCount, objectCount);
+	glUniform4fv(cullShader->location(CullShader::frustumPlanes), 6, &frustum.planes[0][0]);
+	cullShader->set(CullShader::viewProjection, viewProjection);
+	cullShader->set(CullShader::occlusion, occlusion);
+	if (occlusion)
+	{
+		glState.bindTexture(1, GL_TEXTURE_2D, pyramid->getTexture());
+		cullShader->set(CullShader::depthPyramid, 1);
+		cullShader->set(CullShader::pyramidSize, glm::vec2(pyramid->getWidth(), pyramid->getHeight()));
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CullShader::OBJECTS_BINDING, objectBuffer.ID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CullShader::VISIBLE_BINDING, visibleBuffer.ID);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CullShader::COMMAND_BINDING, commandBuffer.ID);
+	//A barreira antes do desenho (comando indireto + atributos) fica com o RenderGraph
+	glDispatchCompute((objectCount + CullShader::WORKGROUP_SIZE - 1) / CullShader::WORKGROUP_SIZE, 1, 1);
+}
+
+void GpuCuller::draw()
+{
+	if (objectCount == 0)
+		return;
+	attachArenaBuffers();
+
+	//As matrizes compactadas j esto em mundo: ObjectData recebe a identidade
+	Mesh::bindIdentityObjectData();
+
+	drawShader->Use();
+	glState.bindTexture(0, GL_TEXTURE_2D, textureID);
+	glState.bindVertexArray(vao.ID);
+	glState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.ID);
+	glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr);
+}
+
+unsigned int GpuCuller::readVisibleCount() const
+{
+	GLuint count = 0;
+	glGetNamedBufferSubData(commandBuffer.ID, offsetof(DrawElementsIndirectCommand, instanceCount), sizeof(GLuint), &count);
+	return count;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "GeometryArena.h"
+#include "GLResources.h"
+#include "Bounds.h"
+#include "DepthPyramid.h"
+
+// Culling na GPU para muitas cpias da mesma malha. Os objetos (matriz model +
+// esfera local) ficam em um SSBO; o cull.comp testa cada um contra o frustum (e a
+// pirmide de profundidade do quadro anterior, se houver) e compacta os visveis
+// em um buffer lido como atributo de instncia (locations 3-6, como no
+// InstancedMesh). O nmero de instncias vai direto para o comando do
+// glDrawElementsIndirect, ento a CPU no l nada de volta e o custo dela no
+// depende da quantidade de objetos.
+class GpuCuller
+{
+public:
+	static const GLuint INSTANCE_BINDING = 1;
+
+	GpuCuller() : cullShader(nullptr), drawShader(nullptr), arena(nullptr), allocation(-1), textureID(0), maxObjects(0), objectCount(0),
+		attachedVertexBuffer(0), attachedIndexBuffer(0) {}
+
+	void initialize(Shader* cullShader, Shader* drawShader, GeometryArena* arena, int allocation, int maxObjects, GLuint textureID);
+	void destroy();
+
+	void setObjects(const std::vector<glm::mat4>& models, const BoundingSphere& localSphere);
+	int getObjectCount() const { return objectCount; }
+	//Comando indireto (as matrizes visveis andam junto)
+	GLuint getCommandBuffer() const { return commandBuffer.ID; }
+
+	//pyramid == nullptr (ou ainda no montada) testa s o frustum
+	void cull(const glm::mat4& viewProjection, const DepthPyramid* pyramid = nullptr);
+	void draw();
+
+	//L o contador da GPU (espera a GPU terminar o culling: s para estatsticas)
+	unsigned int readVisibleCount() const;
+
+protected:
+	struct GpuObject
+	{
+		glm::mat4 model;
+		glm::vec4 localSphere;
+	};
+
+	void attachArenaBuffers();
+
+	Shader* cullShader;
+	Shader* drawShader;
+	GeometryArena* arena;
+	int allocation;
+	GLuint textureID;
+	int maxObjects, objectCount;
+
+	Buffer objectBuffer;  //GpuObject por objeto (entrada)
+	Buffer visibleBuffer; //mat4 por objeto visvel (sada, atributo de instncia)
+	Buffer commandBuffer; //um DrawElementsIndirectCommand
+	VertexArray vao;
+	GLuint attachedVertexBuffer, attachedIndexBuffer;
+};
@@ -0,0 +1,53 @@
+// Interface esperada do programa hello.vs/hello.fs - os nomes aqui so
+// conferidos com os uniforms ativos logo depois do link
+
+#pragma once
+
+#include "UniformReflection.h"
+
+namespace HelloShader
+{
+	//hello.vs
+	constexpr UniformDecl<glm::mat4> projection("projection");
+	constexpr UniformDecl<glm::mat4> view("view");
+
+	//hello.vs - matriz model vem de um trecho do frameStream ligado a este binding
+	constexpr UniformBlockDecl objectData("ObjectData");
+	constexpr GLuint OBJECT_DATA_BINDING = 0;
+	//true enquanto o DrawBatcher desenha (model vem do SSBO DrawData, indexado por gl_DrawID)
+	constexpr UniformDecl<bool> multiDraw("multiDraw");
+
+	//hello.fs - material
+	constexpr UniformDecl<glm::vec3> ka("ka");
+	constexpr UniformDecl<float> kd("kd");
+	constexpr UniformDecl<glm::vec3> ks("ks");
+	constexpr UniformDecl<float> q("q");
+
+	//hello.fs - fonte de luz, cmera e textura
+	constexpr UniformDecl<glm::vec3> lightPos("lightPos");
+	constexpr UniformDecl<glm::vec3> lightColor("lightColor");
+	constexpr UniformDecl<glm::vec3> cameraPos("cameraPos");
+	constexpr UniformDecl<int> colorBuffer("colorBuffer");
+	//true na pr-passagem de profundidade (a iluminao  pulada)
+	constexpr UniformDecl<bool> depthOnly("depthOnly");
+
+	//hello.fs - luzes pontuais por cluster (os SSBOs seguem os bindings do LightClusterShader)
+	constexpr UniformDecl<bool> clusteredLights("clusteredLights");
+	constexpr UniformDecl<glm::ivec3> clusterGrid("clusterGrid");
+	constexpr UniformDecl<glm::vec2> clusterScreenSize("clusterScreenSize");
+	constexpr UniformDecl<glm::vec2> clusterDepthRange("clusterDepthRange");
+	constexpr UniformDecl<int> maxLightsPerCluster("maxLightsPerCluster");
+
+	//Usado por Curve::drawCurve (no existe como uniform no hello.fs)
+	constexpr UniformDecl<glm::vec4> finalColor("finalColor");
+
+	constexpr UniformSignature uniforms[] = {
+		projection, view, multiDraw,
+		ka, kd, ks, q,
+		lightPos, lightColor, cameraPos, colorBuffer, depthOnly,
+		clusteredLights, clusterGrid, clusterScreenSize, clusterDepthRange, maxLightsPerCluster,
+		finalColor
+	};
+
+	constexpr UniformBlockDecl blocks[] = { objectData };
+}
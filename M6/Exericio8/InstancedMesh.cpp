@@ -0,0 +1,101 @@
+#include "InstancedMesh.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <cstddef>
+
+void InstancedMesh::initialize(GeometryArena* arena, int allocation, int maxInstances, Shader* shader, GLuint textureID)
+{
+	Mesh::initialize(arena, allocation, shader, textureID);
+	this->maxInstances = maxInstances;
+	instances.clear();
+	dirtyBegin = dirtyEnd = 0;
+
+	instanceBuffer.initialize((GLsizeiptr)maxInstances * sizeof(glm::mat4), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	//Mesmo formato da arena (locations 0-2, binding 0) + as 4 colunas da matriz no binding 1
+	instanceVAO.initialize();
+	instanceVAO.setAttribute(0, 0, 3, GL_FLOAT, offsetof(MeshVertex, position));
+	instanceVAO.setAttribute(1, 0, 2, GL_FLOAT, offsetof(MeshVertex, texCoord));
+	instanceVAO.setAttribute(2, 0, 3, GL_FLOAT, offsetof(MeshVertex, normal));
+	for (GLuint column = 0; column < 4; column++)
+		instanceVAO.setAttribute(INSTANCE_LOCATION + column, INSTANCE_BINDING, 4, GL_FLOAT, column * sizeof(glm::vec4));
+	instanceVAO.setVertexBuffer(INSTANCE_BINDING, instanceBuffer, 0, sizeof(glm::mat4));
+	instanceVAO.setDivisor(INSTANCE_BINDING, 1);
+
+	attachedVertexBuffer = attachedIndexBuffer = 0;
+	attachArenaBuffers();
+}
+
+void InstancedMesh::destroy()
+{
+	instanceVAO.destroy();
+	instanceBuffer.destroy();
+	instances.clear();
+}
+
+void InstancedMesh::attachArenaBuffers()
+{
+	//A compactao da arena troca os buffers, ento o VAO prprio  religado quando isso acontece
+	if (attachedVertexBuffer == arena->getVertexBuffer() && attachedIndexBuffer == arena->getIndexBuffer())
+		return;
+	attachedVertexBuffer = arena->getVertexBuffer();
+	attachedIndexBuffer = arena->getIndexBuffer();
+	glVertexArrayVertexBuffer(instanceVAO.ID, 0, attachedVertexBuffer, 0, arena->getVertexStride());
+	glVertexArrayElementBuffer(instanceVAO.ID, attachedIndexBuffer);
+}
+
+void InstancedMesh::setInstances(const std::vector<glm::mat4>& models)
+{
+	setInstances(models.data(), (int)models.size());
+}
+
+void InstancedMesh::setInstances(const glm::mat4* models, int count)
+{
+	instances.assign(models, models + std::min(count, maxInstances));
+	dirtyBegin = 0;
+	dirtyEnd = (int)instances.size();
+}
+
+void InstancedMesh::setInstance(int i, const glm::mat4& model)
+{
+	instances[i] = model;
+	if (dirtyBegin == dirtyEnd)
+	{
+		dirtyBegin = i;
+		dirtyEnd = i + 1;
+		return;
+	}
+	dirtyBegin = std::min(dirtyBegin, i);
+	dirtyEnd = std::max(dirtyEnd, i + 1);
+}
+
+void InstancedMesh::draw()
+{
+	if (instances.empty())
+		return;
+
+	//S o trecho alterado  enviado
+	if (dirtyEnd > dirtyBegin)
+	{
+		instanceBuffer.update((GLintptr)dirtyBegin * sizeof(glm::mat4), (GLsizeiptr)(dirtyEnd - dirtyBegin) * sizeof(glm::mat4), &instances[dirtyBegin]);
+		dirtyBegin = dirtyEnd = 0;
+	}
+	attachArenaBuffers();
+
+	const ArenaAllocation& a = arena->get(allocation);
+	glState.bindTexture(0, GL_TEXTURE_2D, textureID);
+	glState.bindVertexArray(instanceVAO.ID);
+	if (a.indexCount > 0)
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, a.indexCount, GL_UNSIGNED_INT, (void*)((size_t)a.firstIndex * sizeof(GLuint)), (GLsizei)instances.size(), a.baseVertex);
+	else
+		glDrawArraysInstanced(GL_TRIANGLES, a.baseVertex, a.vertexCount, (GLsizei)instances.size());
+}
+
+void InstancedMesh::setDefaultInstanceTransform()
+{
+	glVertexAttrib4f(INSTANCE_LOCATION + 0, 1.0f, 0.0f, 0.0f, 0.0f);
+	glVertexAttrib4f(INSTANCE_LOCATION + 1, 0.0f, 1.0f, 0.0f, 0.0f);
+	glVertexAttrib4f(INSTANCE_LOCATION + 2, 0.0f, 0.0f, 1.0f, 0.0f);
+	glVertexAttrib4f(INSTANCE_LOCATION + 3, 0.0f, 0.0f, 0.0f, 1.0f);
+}
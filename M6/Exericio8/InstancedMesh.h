@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "Mesh.h"
+
+// Vrias cpias da mesma malha desenhadas com uma nica chamada
+// (glDrawElementsInstancedBaseVertex). Cada cpia tem a sua matriz model em
+// um buffer de instncias lido pelo hello.vs nas locations 3-6 (divisor 1).
+// A transformao herdada de Mesh (position/scale/angle) vale para o grupo todo.
+class InstancedMesh : public Mesh
+{
+public:
+	static const GLuint INSTANCE_LOCATION = 3; //mat4 ocupa as locations 3, 4, 5 e 6
+	static const GLuint INSTANCE_BINDING = 1;
+
+	InstancedMesh() : maxInstances(0), dirtyBegin(0), dirtyEnd(0), attachedVertexBuffer(0), attachedIndexBuffer(0) {}
+	void initialize(GeometryArena* arena, int allocation, int maxInstances, Shader* shader, GLuint textureID);
+	void destroy();
+
+	void setInstances(const std::vector<glm::mat4>& models);
+	//Matrizes contguas (ex.: TransformBatch::getMatrices)
+	void setInstances(const glm::mat4* models, int count);
+	void setInstance(int i, const glm::mat4& model);
+	int getInstanceCount() const { return (int)instances.size(); }
+
+	void draw();
+
+	//Valor dos atributos 3-6 quando o VAO no tem o buffer de instncias (Mesh comum): identidade
+	static void setDefaultInstanceTransform();
+
+protected:
+	void attachArenaBuffers();
+
+	std::vector<glm::mat4> instances;
+	int maxInstances;
+	int dirtyBegin, dirtyEnd; //Intervalo de instncias alteradas desde o ltimo envio
+	Buffer instanceBuffer;
+	VertexArray instanceVAO;
+	GLuint attachedVertexBuffer, attachedIndexBuffer;
+};
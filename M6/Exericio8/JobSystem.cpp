@@ -0,0 +1,324 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+JobSystem jobSystem;
+
+//Posio da thread atual em slots (-1 = thread de fora do sistema)
+static thread_local int currentSlot = -1;
+
+bool JobSystem::Deque::push(Job* job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t >= CAPACITY)
+		return false;
+	jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+	return true;
+}
+
+JobSystem::Job* JobSystem::Deque::pop()
+{
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+	if (t > b)
+	{
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	//ltimo job da fila: disputa com quem estiver roubando
+	if (t == b)
+	{
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::Deque::steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+	if (t >= b)
+		return nullptr;
+
+	Job* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+	return job;
+}
+
+void JobSystem::initialize(int workers)
+{
+	destroy();
+	if (workers <= 0)
+		workers = std::max(1, (int)std::thread::hardware_concurrency()) - 1;
+
+	slots.clear();
+	for (int s = 0; s <= workers; s++)
+	{
+		slots.push_back(std::unique_ptr<Slot>(new Slot()));
+		slots.back()->random = 2654435761u * (s + 1);
+	}
+	previous.assign(slots.size(), JobWorkerStats{});
+	frameStart = glfwGetTime();
+
+	currentSlot = 0;
+	running = true;
+	for (int s = 1; s <= workers; s++)
+		this->workers.emplace_back(&JobSystem::workerLoop, this, s);
+}
+
+void JobSystem::destroy()
+{
+	if (!running)
+		return;
+	running = false;
+	wake.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+	currentSlot = -1;
+}
+
+void JobSystem::run(const std::function<void()>& job, JobCounter* counter)
+{
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	submit(job, counter);
+}
+
+void JobSystem::runAfter(JobCounter& dependency, const std::function<void()>& job, JobCounter* counter)
+{
+	if (counter)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(dependency.mutex);
+		if (dependency.pending.load(std::memory_order_acquire) > 0)
+		{
+			dependency.continuations.push_back(JobCounter::Continuation{ job, counter });
+			return;
+		}
+	}
+	submit(job, counter);
+}
+
+void JobSystem::submit(const std::function<void()>& job, JobCounter* counter)
+{
+	int slot = currentSlot;
+	if (!running)
+	{
+		//Sem threads (antes de initialize ou depois de destroy) o job roda na hora
+		execute(job, counter, slot);
+		return;
+	}
+	if (slot < 0)
+	{
+		std::lock_guard<std::mutex> lock(injectedMutex);
+		injected.push_back(JobCounter::Continuation{ job, counter });
+	}
+	else
+	{
+		//O pool  um anel: se o prximo job ainda no terminou (ou a fila encheu), quem envia executa
+		Slot& owner = *slots[slot];
+		Job* pooled = &owner.pool[owner.next % MAX_JOBS];
+		if (!pooled->free.load(std::memory_order_acquire))
+		{
+			execute(job, counter, slot);
+			return;
+		}
+		owner.next++;
+		pooled->function = job;
+		pooled->counter = counter;
+		pooled->free.store(false, std::memory_order_relaxed);
+		if (!owner.deque.push(pooled))
+		{
+			pooled->function = nullptr;
+			pooled->free.store(true, std::memory_order_release);
+			execute(job, counter, slot);
+			return;
+		}
+	}
+
+	if (sleeping.load(std::memory_order_relaxed) > 0)
+		wake.notify_one();
+}
+
+bool JobSystem::runOne(int slot)
+{
+	Job* job = slot >= 0 ? slots[slot]->deque.pop() : nullptr;
+
+	//Fila prpria vazia: rouba de uma thread sorteada, depois das outras em ordem
+	if (!job)
+	{
+		static thread_local uint32_t outsideRandom = 12345;
+		uint32_t& random = slot >= 0 ? slots[slot]->random : outsideRandom;
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		int count = (int)slots.size();
+		int first = count > 0 ? (int)(random % count) : 0;
+		for (int v = 0; v < count && !job; v++)
+		{
+			int victim = (first + v) % count;
+			if (victim != slot)
+				job = slots[victim]->deque.steal();
+		}
+		if (job && slot >= 0)
+			slots[slot]->steals.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (job)
+	{
+		std::function<void()> function;
+		function.swap(job->function);
+		JobCounter* counter = job->counter;
+		job->free.store(true, std::memory_order_release);
+		execute(function, counter, slot);
+		return true;
+	}
+
+	JobCounter::Continuation outside;
+	{
+		std::lock_guard<std::mutex> lock(injectedMutex);
+		if (injected.empty())
+			return false;
+		outside = std::move(injected.front());
+		injected.pop_front();
+	}
+	execute(outside.function, outside.counter, slot);
+	return true;
+}
+
+void JobSystem::execute(const std::function<void()>& job, JobCounter* counter, int slot)
+{
+	double start = glfwGetTime();
+	job();
+	if (slot >= 0 && running)
+	{
+		Slot& owner = *slots[slot];
+		owner.jobs.fetch_add(1, std::memory_order_relaxed);
+		//S a prpria thread escreve o seu tempo
+		owner.busyTime.store(owner.busyTime.load(std::memory_order_relaxed) + glfwGetTime() - start, std::memory_order_relaxed);
+	}
+	if (counter)
+		finish(*counter);
+}
+
+void JobSystem::finish(JobCounter& counter)
+{
+	int pending = counter.pending.load(std::memory_order_acquire);
+	while (true)
+	{
+		if (pending > 1)
+		{
+			if (counter.pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel))
+				return;
+			continue;
+		}
+
+		//ltimo job: zera com o mutex, para runAfter no perder um dependente
+		std::vector<JobCounter::Continuation> ready;
+		{
+			std::lock_guard<std::mutex> lock(counter.mutex);
+			int one = 1;
+			if (!counter.pending.compare_exchange_strong(one, 0, std::memory_order_acq_rel))
+			{
+				pending = one;
+				continue;
+			}
+			ready.swap(counter.continuations);
+		}
+		//Daqui em diante o contador pode j ter sido destrudo por quem esperava
+		for (JobCounter::Continuation& next : ready)
+			submit(next.function, next.counter);
+		return;
+	}
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	while (counter.pending.load(std::memory_order_acquire) > 0)
+		if (!runOne(running ? currentSlot : -1))
+			std::this_thread::yield();
+	//Quem zerou o contador ainda pode estar saindo do mutex dele
+	std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+bool JobSystem::help()
+{
+	return runOne(running ? currentSlot : -1);
+}
+
+void JobSystem::parallelFor(int count, int minBatch, const std::function<void(int, int)>& body)
+{
+	if (count <= 0)
+		return;
+	minBatch = std::max(minBatch, 1);
+	//Alguns trechos por thread equilibram a carga sem encher as filas
+	int chunks = std::min((count + minBatch - 1) / minBatch, getThreadCount() * 4);
+	if (chunks <= 1 || !running)
+	{
+		body(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (int c = 1; c < chunks; c++)
+	{
+		int begin = (int)((int64_t)count * c / chunks);
+		int end = (int)((int64_t)count * (c + 1) / chunks);
+		run([&body, begin, end]() { body(begin, end); }, &counter);
+	}
+	body(0, (int)((int64_t)count / chunks));
+	wait(counter);
+}
+
+void JobSystem::endFrame()
+{
+	double now = glfwGetTime();
+	double elapsed = std::max(now - frameStart, 1e-9);
+	frameStart = now;
+
+	for (size_t s = 0; s < slots.size(); s++)
+	{
+		Slot& slot = *slots[s];
+		unsigned int jobs = slot.jobs.load(std::memory_order_relaxed);
+		unsigned int steals = slot.steals.load(std::memory_order_relaxed);
+		double busyTime = slot.busyTime.load(std::memory_order_relaxed);
+		previous[s].jobs = jobs - slot.lastJobs;
+		previous[s].steals = steals - slot.lastSteals;
+		previous[s].busyTime = busyTime - slot.lastBusyTime;
+		previous[s].utilization = (float)std::min(previous[s].busyTime / elapsed, 1.0);
+		slot.lastJobs = jobs;
+		slot.lastSteals = steals;
+		slot.lastBusyTime = busyTime;
+	}
+}
+
+void JobSystem::workerLoop(int slot)
+{
+	currentSlot = slot;
+	while (running)
+	{
+		if (runOne(slot))
+			continue;
+
+		//Sem trabalho: dorme at um envio (ou 1 ms, caso o aviso chegue antes de dormir)
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleeping++;
+		wake.wait_for(lock, std::chrono::milliseconds(1));
+		sleeping--;
+	}
+}
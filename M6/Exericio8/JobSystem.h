@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JobWorkerStats
+{
+	unsigned int jobs;   //Jobs executados pela thread
+	unsigned int steals; //Jobs tirados da fila de outra thread
+	double busyTime;     //Tempo executando jobs (s)
+	float utilization;   //busyTime / durao do quadro
+};
+
+// Contador de jobs em andamento: run() soma 1, o fim do job subtrai 1 e
+// JobSystem::wait espera chegar a 0. Jobs podem depender de um contador
+// (runAfter): s entram nas filas quando ele zera. Um dependente registrado
+// com o contador j em 0 comea na hora, ento os jobs de uma etapa precisam
+// ser enviados antes que os primeiros possam terminar (ex.: de dentro de um job).
+class JobCounter
+{
+public:
+	JobCounter() : pending(0) {}
+	bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+	struct Continuation
+	{
+		std::function<void()> function;
+		JobCounter* counter;
+	};
+
+	std::atomic<int> pending;
+	std::mutex mutex;
+	std::vector<Continuation> continuations;
+};
+
+// Sistema de jobs com roubo de trabalho. H uma thread por ncleo alm da
+// thread que chamou initialize (a da OpenGL), e cada uma tem uma fila
+// Chase-Lev sem trava: a dona empilha e desempilha no fundo, as outras roubam
+// do topo quando a prpria fila esvazia. A thread da OpenGL no fica parada
+// em wait: executa jobs at o contador zerar.
+// Threads de fora (ex.: a do FramePipeline) tambm podem enviar e esperar;
+// os jobs delas vo para uma fila comum com mutex.
+class JobSystem
+{
+public:
+	//Jobs em voo por thread que envia (acima disso o job roda na hora, em quem enviou)
+	static const int MAX_JOBS = 4096;
+
+	JobSystem() : running(false), sleeping(0), frameStart(0.0) {}
+
+	//workers = 0 usa um por ncleo (menos o da thread atual)
+	void initialize(int workers = 0);
+	void destroy();
+	//Threads que executam jobs, contando a que chamou initialize
+	int getThreadCount() const { return (int)slots.size(); }
+
+	void run(const std::function<void()>& job, JobCounter* counter = nullptr);
+	//O job s comea depois que dependency zerar
+	void runAfter(JobCounter& dependency, const std::function<void()>& job, JobCounter* counter = nullptr);
+	//Executa outros jobs enquanto o contador no zera
+	void wait(JobCounter& counter);
+	//Executa um job pendente, se houver; para quem espera algo que no  um contador
+	bool help();
+
+	//body(begin, end) em trechos de pelo menos minBatch ndices; retorna quando todos terminam
+	void parallelFor(int count, int minBatch, const std::function<void(int, int)>& body);
+
+	//Fecha as estatsticas por thread (ndice 0 = thread da OpenGL)
+	void endFrame();
+	const std::vector<JobWorkerStats>& lastFrame() const { return previous; }
+
+protected:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter = nullptr;
+		std::atomic<bool> free{ true };
+	};
+
+	class Deque
+	{
+	public:
+		static const int CAPACITY = MAX_JOBS; //potncia de 2
+
+		Deque() : top(0), bottom(0) {}
+		bool push(Job* job);  //s a dona
+		Job* pop();           //s a dona
+		Job* steal();         //qualquer thread
+
+	private:
+		std::atomic<int64_t> top, bottom;
+		std::atomic<Job*> jobs[CAPACITY];
+	};
+
+	struct Slot
+	{
+		Deque deque;
+		Job pool[MAX_JOBS];
+		unsigned int next = 0;
+		uint32_t random = 1;
+		std::atomic<unsigned int> jobs{ 0 }, steals{ 0 };
+		std::atomic<double> busyTime{ 0.0 };
+		//Totais no ltimo endFrame
+		unsigned int lastJobs = 0, lastSteals = 0;
+		double lastBusyTime = 0.0;
+	};
+
+	void submit(const std::function<void()>& job, JobCounter* counter);
+	bool runOne(int slot);
+	void execute(const std::function<void()>& job, JobCounter* counter, int slot);
+	void finish(JobCounter& counter);
+	void workerLoop(int slot);
+
+	std::vector<std::unique_ptr<Slot>> slots;
+	std::vector<std::thread> workers;
+	std::atomic<bool> running;
+
+	std::mutex injectedMutex;
+	std::deque<JobCounter::Continuation> injected;
+
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<int> sleeping;
+
+	double frameStart;
+	std::vector<JobWorkerStats> previous;
+};
+
+extern JobSystem jobSystem;
@@ -1,4 +1,9 @@
 #include "Mesh.h"
+#include "HelloShader.h"
+#include "StreamBuffer.h"
+#include "GLResources.h"
+
+#include <cstring>
 
 void Mesh::initialize(GLuint VAO, int nVertices, Shader* shader, GLuint textureID, glm::vec3 position, glm::vec3 scale, float angle, glm::vec3 axis)
 {
@@ -10,27 +15,124 @@ void Mesh::initialize(GLuint VAO, int nVertices, Shader* shader, GLuint textureI
 	this->angle = angle;
 	this->axis = axis;
 	this->textureID = textureID;
+	this->arena = nullptr;
+	this->allocation = -1;
+	updateModelMatrix();
 }
 
-void Mesh::update()
+void Mesh::initialize(GeometryArena* arena, int allocation, Shader* shader, GLuint textureID, glm::vec3 position, glm::vec3 scale, float angle, glm::vec3 axis)
+{
+	initialize(arena->getVAO().ID, arena->get(allocation).vertexCount, shader, textureID, position, scale, angle, axis);
+	this->arena = arena;
+	this->allocation = allocation;
+}
+
+void Mesh::updateModelMatrix()
 {
-	glm::mat4 model = glm::mat4(1);
-	model = glm::translate(model, position);
+	model = glm::translate(glm::mat4(1), position);
 	model = glm::rotate(model, glm::radians(angle), axis);
 	model = glm::scale(model, scale);
-	shader->setMat4("model", glm::value_ptr(model));
+}
+
+void Mesh::update()
+{
+	bindObjectData(getModelMatrix());
+}
+
+void Mesh::bindObjectData(const glm::mat4& model)
+{
+	bindObjectData(writeObjectData(model));
+}
+
+StreamAllocation Mesh::writeObjectData(const glm::mat4& model)
+{
+	//A matriz vai direto para a memria mapeada do quadro; s o trecho  ligado ao bloco ObjectData
+	StreamAllocation slice = frameStream.allocate(sizeof(glm::mat4), uniformBufferAlignment());
+	if (slice.data)
+		memcpy(slice.data, glm::value_ptr(model), sizeof(glm::mat4));
+	return slice;
+}
+
+void Mesh::bindObjectData(const StreamAllocation& slice)
+{
+	if (!slice.data)
+		return;
+	glBindBufferRange(GL_UNIFORM_BUFFER, HelloShader::OBJECT_DATA_BINDING, frameStream.ID, slice.offset, slice.size);
+}
+
+static Buffer identityObjectData;
+
+void Mesh::bindIdentityObjectData()
+{
+	if (!identityObjectData.isValid())
+	{
+		glm::mat4 identity(1.0f);
+		identityObjectData.initialize(sizeof(glm::mat4), glm::value_ptr(identity));
+	}
+	glBindBufferRange(GL_UNIFORM_BUFFER, HelloShader::OBJECT_DATA_BINDING, identityObjectData.ID, 0, sizeof(glm::mat4));
+}
+
+void Mesh::destroyIdentityObjectData()
+{
+	identityObjectData.destroy();
 }
 
 void Mesh::draw()
 {
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glBindVertexArray(VAO);
+	//O cache descarta os binds repetidos, ento no  preciso desvincular no final
+	glState.bindTexture(0, GL_TEXTURE_2D, textureID);
+	if (arena)
+	{
+		arena->draw(allocation);
+		return;
+	}
+	glState.bindVertexArray(VAO);
 	glDrawArrays(GL_TRIANGLES, 0, nVertices);
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Mesh::submit(DrawBatcher& batcher)
+{
+	return arena && batcher.add(shader, arena, allocation, textureID, getModelMatrix());
+}
+
+void Mesh::record(CommandList& list, const StreamAllocation& objectData) const
+{
+	memcpy(objectData.data, glm::value_ptr(getModelMatrix()), sizeof(glm::mat4));
+
+	list.useProgram(shader->ID);
+	list.bindUniformRange(HelloShader::OBJECT_DATA_BINDING, frameStream.ID, objectData.offset, sizeof(glm::mat4));
+	list.bindTexture(0, textureID);
+	if (arena)
+	{
+		const ArenaAllocation& a = arena->get(allocation);
+		list.bindVertexArray(arena->getVAO().ID);
+		if (a.indexCount > 0)
+			list.drawElements(a.indexCount, a.firstIndex, a.baseVertex);
+		else
+			list.drawArrays(a.baseVertex, a.vertexCount);
+		return;
+	}
+	list.bindVertexArray(VAO);
+	list.drawArrays(0, nVertices);
+}
+
+void Mesh::setBounds(const BoundingBox& box, const BoundingSphere& sphere)
+{
+	localBox = box;
+	localSphere = sphere;
+}
+
+BoundingSphere Mesh::getWorldSphere() const
+{
+	return transformSphere(localSphere, getModelMatrix());
+}
+
+BoundingBox Mesh::getWorldBox() const
+{
+	return transformBox(localBox, getModelMatrix());
 }
 
 void Mesh::updatePosition(glm::vec3 position) {
 	this->position = position;
+	updateModelMatrix();
 }
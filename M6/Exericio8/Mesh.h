@@ -6,27 +6,76 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Shader.h"
+#include "GeometryArena.h"
+#include "DrawBatcher.h"
+#include "Bounds.h"
+#include "CommandList.h"
+#include "StreamBuffer.h"
 
 
 class Mesh
 {
 public:
-	Mesh() {}
+	Mesh() : arena(nullptr), allocation(-1), model(1), localBox{}, localSphere{}, staticMesh(false) {}
 	~Mesh() {}
 	void initialize(GLuint VAO, int nVertices, Shader* shader, GLuint textureID, glm::vec3 position = glm::vec3(0.0, 0.0, 0.0), glm::vec3 scale = glm::vec3(1.0, 1.0, 1.0), float angle = 0.0, glm::vec3 axis = glm::vec3(0.0, 0.0, 1.0));
+	//Malha sub-alocada em uma GeometryArena (desenhada com o VAO compartilhado da arena)
+	void initialize(GeometryArena* arena, int allocation, Shader* shader, GLuint textureID, glm::vec3 position = glm::vec3(0.0, 0.0, 0.0), glm::vec3 scale = glm::vec3(1.0, 1.0, 1.0), float angle = 0.0, glm::vec3 axis = glm::vec3(0.0, 0.0, 1.0));
 	void update();
 	void draw();
+	//Entrega a malha ao lote do quadro em vez de update() + draw(); false para malhas fora da arena
+	bool submit(DrawBatcher& batcher);
+	//Mesmo efeito de Use() + update() + draw(), gravado em uma lista (pode rodar fora da thread da OpenGL).
+	//objectData  o trecho do frameStream reservado para a matriz desta malha
+	void record(CommandList& list, const StreamAllocation& objectData) const;
+	//Guardada entre os quadros; s  recomposta quando a posio muda
+	const glm::mat4& getModelMatrix() const { return model; }
 	void updatePosition(glm::vec3 position);
 
+	Shader* getShader() const { return shader; }
+	GLuint getTextureID() const { return textureID; }
+	GLuint getVertexArray() const { return arena ? arena->getVAO().ID : VAO; }
+	glm::vec3 getPosition() const { return position; }
+
+	//Limites no espao do modelo (calculados pelo loader do OBJ)
+	void setBounds(const BoundingBox& box, const BoundingSphere& sphere);
+	BoundingSphere getWorldSphere() const;
+	BoundingBox getWorldBox() const;
+
+	//Malhas estticas no se movem depois de posicionadas: vo para o StaticBatcher
+	void setStatic(bool staticMesh) { this->staticMesh = staticMesh; }
+	bool isStatic() const { return staticMesh; }
+
+	//Escreve a matriz no frameStream e liga o trecho ao bloco ObjectData do hello.vs
+	static void bindObjectData(const glm::mat4& model);
+	//As duas metades separadas: a matriz  escrita uma vez e o trecho religado em cada passada
+	static StreamAllocation writeObjectData(const glm::mat4& model);
+	static void bindObjectData(const StreamAllocation& slice);
+	//Identidade em um UBO fixo (geometria j em coordenadas de mundo), sem escrita por quadro
+	static void bindIdentityObjectData();
+	static void destroyIdentityObjectData();
+
 protected:
+	//Compe model a partir de position, angle/axis e scale
+	void updateModelMatrix();
+
 	GLuint VAO; //Identificador do Vertex Array Object - Vrtices e seus atributos
 	int nVertices;
 
+	//Quando arena != nullptr, a geometria vem da alocao na arena em vez do VAO prprio
+	GeometryArena* arena;
+	int allocation;
+
 	//Informaes sobre as transformaes a serem aplicadas no objeto
 	glm::vec3 position;
 	glm::vec3 scale;
 	float angle;
 	glm::vec3 axis;
+	glm::mat4 model;
+
+	BoundingBox localBox;
+	BoundingSphere localSphere;
+	bool staticMesh;
 
 	//Referncia (endereo) do shader
 	Shader* shader;
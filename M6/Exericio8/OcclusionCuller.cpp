@@ -0,0 +1,283 @@
+#include "OcclusionCuller.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define OCCLUSION_CULLER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE
+#endif
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+//Vrtices com w menor que isso esto atrs (ou muito perto) da cmera
+static const float MIN_W = 1e-4f;
+
+void OcclusionCuller::initialize(int width, int height, int threads)
+{
+	this->width = (width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+	this->height = (height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+	tilesX = this->width / TILE_SIZE;
+	tilesY = this->height / TILE_SIZE;
+
+	if (threads <= 0)
+		threads = std::max(1, jobSystem.getThreadCount());
+	bandCount = std::min(threads, tilesY);
+
+	depth.assign(this->width * this->height, 1.0f);
+	tileMax.assign(tilesX * tilesY, 1.0f);
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjection)
+{
+	this->viewProjection = viewProjection;
+	triangles.clear();
+	std::fill(depth.begin(), depth.end(), 1.0f);
+	std::fill(tileMax.begin(), tileMax.end(), 1.0f);
+}
+
+void OcclusionCuller::addOccluder(const std::vector<float>& positions, const glm::mat4& model)
+{
+	glm::mat4 mvp = viewProjection * model;
+	for (size_t t = 0; t + 9 <= positions.size(); t += 9)
+	{
+		ScreenTriangle triangle;
+		bool behind = false;
+		for (int i = 0; i < 3; i++)
+		{
+			glm::vec4 clip = mvp * glm::vec4(positions[t + i * 3], positions[t + i * 3 + 1], positions[t + i * 3 + 2], 1.0f);
+			//Sem recorte no plano near: descartar um oclusor s deixa o teste mais conservador
+			if (clip.w < MIN_W)
+			{
+				behind = true;
+				break;
+			}
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			triangle.v[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+		}
+		if (behind)
+			continue;
+
+		triangle.minY = std::min(triangle.v[0].y, std::min(triangle.v[1].y, triangle.v[2].y));
+		triangle.maxY = std::max(triangle.v[0].y, std::max(triangle.v[1].y, triangle.v[2].y));
+		if (triangle.maxY < 0.0f || triangle.minY > (float)height)
+			continue;
+		triangles.push_back(triangle);
+	}
+}
+
+void OcclusionCuller::render()
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	//Cada faixa  um conjunto de linhas de blocos; os jobs no escrevem nos mesmos pixels
+	jobSystem.parallelFor(bandCount, 1, [this](int begin, int end)
+		{
+			for (int band = begin; band < end; band++)
+				renderBand(band);
+		});
+
+	current.occluderTriangles += (unsigned int)triangles.size();
+	current.rasterTime += secondsSince(start);
+}
+
+void OcclusionCuller::renderBand(int band)
+{
+	int tileRowBegin = tilesY * band / bandCount;
+	int tileRowEnd = tilesY * (band + 1) / bandCount;
+	int rowBegin = tileRowBegin * TILE_SIZE;
+	int rowEnd = tileRowEnd * TILE_SIZE;
+
+	for (const ScreenTriangle& triangle : triangles)
+		if (triangle.maxY >= (float)rowBegin && triangle.minY < (float)rowEnd)
+			rasterize(triangle, rowBegin, rowEnd);
+	updateTiles(rowBegin, rowEnd);
+}
+
+void OcclusionCuller::rasterize(const ScreenTriangle& triangle, int rowBegin, int rowEnd)
+{
+	glm::vec3 a = triangle.v[0], b = triangle.v[1], c = triangle.v[2];
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (std::fabs(area) < 1e-8f)
+		return;
+	//Os dois lados so rasterizados: o sentido dos oclusores no importa
+	if (area < 0.0f)
+	{
+		std::swap(b, c);
+		area = -area;
+	}
+
+	//Funes de aresta E(x, y) = A x + B y + C, positivas dentro do tringulo
+	float edgeA[3] = { a.y - b.y, b.y - c.y, c.y - a.y };
+	float edgeB[3] = { b.x - a.x, c.x - b.x, a.x - c.x };
+	float edgeC[3] = { a.x * b.y - a.y * b.x, b.x * c.y - b.y * c.x, c.x * a.y - c.y * a.x };
+
+	//Plano da profundidade z(x, y) = zA x + zB y + zC (interpolao linear em tela)
+	float zA = ((b.z - a.z) * (c.y - a.y) - (c.z - a.z) * (b.y - a.y)) / area;
+	float zB = ((c.z - a.z) * (b.x - a.x) - (b.z - a.z) * (c.x - a.x)) / area;
+	float zC = a.z - zA * a.x - zB * a.y;
+
+	int minX = std::max(0, (int)std::floor(std::min(a.x, std::min(b.x, c.x))));
+	int maxX = std::min(width - 1, (int)std::ceil(std::max(a.x, std::max(b.x, c.x))));
+	int minY = std::max(rowBegin, (int)std::floor(triangle.minY));
+	int maxY = std::min(rowEnd - 1, (int)std::ceil(triangle.maxY));
+	if (minX > maxX || minY > maxY)
+		return;
+	minX &= ~7; //blocos de 8 pixels alinhados; os pixels fora do tringulo falham nas arestas
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = y + 0.5f;
+		float* row = &depth[y * width];
+#if defined(OCCLUSION_CULLER_AVX)
+		__m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+		__m256 rowE0 = _mm256_set1_ps(edgeB[0] * py + edgeC[0]);
+		__m256 rowE1 = _mm256_set1_ps(edgeB[1] * py + edgeC[1]);
+		__m256 rowE2 = _mm256_set1_ps(edgeB[2] * py + edgeC[2]);
+		__m256 rowZ = _mm256_set1_ps(zB * py + zC);
+		__m256 zero = _mm256_setzero_ps();
+		for (int x = minX; x <= maxX; x += 8)
+		{
+			__m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), offsets);
+			__m256 e0 = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(edgeA[0])), rowE0);
+			__m256 e1 = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(edgeA[1])), rowE1);
+			__m256 e2 = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(edgeA[2])), rowE2);
+			__m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+				_mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+			if (_mm256_movemask_ps(inside) == 0)
+				continue;
+			__m256 z = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(zA)), rowZ);
+			__m256 old = _mm256_loadu_ps(row + x);
+			_mm256_storeu_ps(row + x, _mm256_blendv_ps(old, _mm256_min_ps(old, z), inside));
+		}
+#elif defined(OCCLUSION_CULLER_SSE)
+		//Duas metades de 4 pixels por bloco; sem blendv no SSE2, a mscara escolhe com and/andnot/or
+		__m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		__m128 rowE0 = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+		__m128 rowE1 = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+		__m128 rowE2 = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+		__m128 rowZ = _mm_set1_ps(zB * py + zC);
+		__m128 zero = _mm_setzero_ps();
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(edgeA[0])), rowE0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(edgeA[1])), rowE1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(edgeA[2])), rowE2);
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+			__m128 z = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(zA)), rowZ);
+			__m128 old = _mm_loadu_ps(row + x);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(old, z)), _mm_andnot_ps(inside, old)));
+		}
+#else
+		for (int x = minX; x <= maxX; x++)
+		{
+			float px = x + 0.5f;
+			if (edgeA[0] * px + edgeB[0] * py + edgeC[0] < 0.0f || edgeA[1] * px + edgeB[1] * py + edgeC[1] < 0.0f
+				|| edgeA[2] * px + edgeB[2] * py + edgeC[2] < 0.0f)
+				continue;
+			row[x] = std::min(row[x], zA * px + zB * py + zC);
+		}
+#endif
+	}
+}
+
+void OcclusionCuller::updateTiles(int rowBegin, int rowEnd)
+{
+	for (int ty = rowBegin / TILE_SIZE; ty < rowEnd / TILE_SIZE; ty++)
+		for (int tx = 0; tx < tilesX; tx++)
+		{
+			float farthest = 0.0f;
+			for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; y++)
+				for (int x = tx * TILE_SIZE; x < (tx + 1) * TILE_SIZE; x++)
+					farthest = std::max(farthest, depth[y * width + x]);
+			tileMax[ty * tilesX + tx] = farthest;
+		}
+}
+
+bool OcclusionCuller::isVisible(const BoundingBox& box)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	current.tested++;
+
+	//Retngulo em tela e profundidade mais prxima dos 8 cantos
+	glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+	float nearest = 1.0f;
+	bool crossesNear = false;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 p((corner & 1) ? box.max.x : box.min.x, (corner & 2) ? box.max.y : box.min.y, (corner & 4) ? box.max.z : box.min.z);
+		glm::vec4 clip = viewProjection * glm::vec4(p, 1.0f);
+		if (clip.w < MIN_W)
+		{
+			crossesNear = true;
+			break;
+		}
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 screen((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+	if (crossesNear)
+	{
+		current.testTime += secondsSince(start);
+		return true;
+	}
+
+	int minX = std::max(0, (int)std::floor(screenMin.x));
+	int maxX = std::min(width - 1, (int)std::floor(screenMax.x));
+	int minY = std::max(0, (int)std::floor(screenMin.y));
+	int maxY = std::min(height - 1, (int)std::floor(screenMax.y));
+
+	//Fora da tela o frustum culling decide; aqui conta como visvel
+	bool visible = minX > maxX || minY > maxY;
+	for (int ty = minY / TILE_SIZE; !visible && ty <= maxY / TILE_SIZE; ty++)
+		for (int tx = minX / TILE_SIZE; !visible && tx <= maxX / TILE_SIZE; tx++)
+		{
+			//Bloco inteiro mais perto que a caixa: nada a ler
+			if (nearest > tileMax[ty * tilesX + tx])
+				continue;
+			int x0 = std::max(minX, tx * TILE_SIZE), x1 = std::min(maxX, tx * TILE_SIZE + TILE_SIZE - 1);
+			int y0 = std::max(minY, ty * TILE_SIZE), y1 = std::min(maxY, ty * TILE_SIZE + TILE_SIZE - 1);
+			for (int y = y0; !visible && y <= y1; y++)
+				for (int x = x0; x <= x1; x++)
+					if (nearest <= depth[y * width + x])
+					{
+						visible = true;
+						break;
+					}
+		}
+
+	if (!visible)
+		current.culled++;
+	current.testTime += secondsSince(start);
+	return visible;
+}
+
+const char* OcclusionCuller::getRasterPath()
+{
+#if defined(OCCLUSION_CULLER_AVX)
+	return "AVX, 8 pixels";
+#elif defined(OCCLUSION_CULLER_SSE)
+	return "SSE2, 4 pixels";
+#else
+	return "escalar";
+#endif
+}
+
+void OcclusionCuller::endFrame()
+{
+	previous = current;
+	current = OcclusionStats{};
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+struct OcclusionStats
+{
+	unsigned int occluderTriangles;
+	unsigned int tested;
+	unsigned int culled;
+	double rasterTime; //segundos
+	double testTime;
+};
+
+// Culling por ocluso na CPU. Os oclusores escolhidos so rasterizados em um depth
+// buffer pequeno de float por pixel (profundidade NDC em [0, 1], preciso cheia, s o
+// mnimo  guardado; no  um buffer mascarado com camadas comprimidas), dividido em
+// faixas horizontais rasterizadas em paralelo pelo JobSystem. Por cima dele h um
+// s nvel hierrquico: blocos de 8x8 pixels com a maior profundidade do bloco, ento
+// uma caixa atrs de um bloco inteiro  descartada sem ler os pixels.
+// A rasterizao avalia 8 pixels por vez com AVX, duas vezes 4 com SSE2 e um pixel
+// por vez fora do x86 (getRasterPath). S depende do GLM: roda sem contexto GL.
+class OcclusionCuller
+{
+public:
+	static const int TILE_SIZE = 8;
+
+	OcclusionCuller() : width(0), height(0), tilesX(0), tilesY(0), bandCount(0), previous{}, current{} {}
+
+	//width e height so arredondados para mltiplos de TILE_SIZE; threads = 0 usa uma faixa por thread do JobSystem
+	void initialize(int width, int height, int threads = 0);
+
+	//Limpa o buffer e fixa a view-projection do quadro
+	void beginFrame(const glm::mat4& viewProjection);
+	//Lista de tringulos (x, y, z por vrtice, como o loadOBJ gera) com a matriz model do objeto
+	void addOccluder(const std::vector<float>& positions, const glm::mat4& model);
+	//Rasteriza os oclusores adicionados desde beginFrame
+	void render();
+	//false s quando a caixa (coordenadas de mundo) est inteira atrs dos oclusores
+	bool isVisible(const BoundingBox& box);
+	void endFrame();
+
+	const OcclusionStats& lastFrame() const { return previous; }
+	//Caminho de rasterizao escolhido na compilao (para o relatrio)
+	static const char* getRasterPath();
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	float getDepth(int x, int y) const { return depth[y * width + x]; }
+
+protected:
+	struct ScreenTriangle
+	{
+		glm::vec3 v[3]; //x, y em pixels e profundidade
+		float minY, maxY;
+	};
+
+	void renderBand(int band);
+	void rasterize(const ScreenTriangle& triangle, int rowBegin, int rowEnd);
+	void updateTiles(int rowBegin, int rowEnd);
+
+	int width, height;
+	int tilesX, tilesY;
+	int bandCount;
+	glm::mat4 viewProjection;
+	std::vector<float> depth;
+	std::vector<float> tileMax;
+	std::vector<ScreenTriangle> triangles;
+	OcclusionStats previous, current;
+};
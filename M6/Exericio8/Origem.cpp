@@ -16,6 +16,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdio>
+#include <algorithm>
  // GLAD
 #include <glad/glad.h>
 
@@ -29,49 +30,212 @@
 
 #include "Shader.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
 #include "Shader.h"
 #include "Mesh.h"
 #include "Camera.h"
 #include "Hermite.h"
 #include "Bezier.h"
 #include "CatmullRom.h"
+#include "HelloShader.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+#include "GLResources.h"
+#include "StreamBuffer.h"
+#include "InstancedMesh.h"
+#include "DrawBatcher.h"
+#include "RenderQueue.h"
+#include "FrustumCuller.h"
+#include "DynamicTree.h"
+#include "OcclusionCuller.h"
+#include "GpuCuller.h"
+#include "GpuCullShaders.h"
+#include "DepthPyramid.h"
+#include "StaticBatcher.h"
+#include "PipelineStatistics.h"
+#include "ClusteredLighting.h"
+#include "ClusteredLightingShaders.h"
+#include "DynamicResolution.h"
+#include "RenderGraph.h"
+#include "FramePipeline.h"
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+#include "AssetLoader.h"
+#include "Task.h"
+#include "EntityWorld.h"
+#include "SceneComponents.h"
+#include "SceneSystems.h"
+#include "SceneGraph.h"
+#include "TransformBatch.h"
 
 
 // Prottipos das funes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-int setupGeometry();
-int loadTexture(string path);
-void loadOBJ(string path);
-void loadMTL(string path);
+struct SuzanneAssets
+{
+	MeshAsset mesh;
+	MaterialAsset material;
+	TextureAsset texture;
+};
+Task<SuzanneAssets> loadSuzanne(string objPath, string directory);
 vector<glm::vec3> generateControlPointsSet(const std::string& input);
+vector<glm::mat4> generateInstanceGrid(int n, float spacing);
+vector<PointLight> generateLights(int n, const BoundingBox& area, float radius);
+void runJobBenchmark();
+void runTransformBenchmark();
 
 
 // VARIAVEIS
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 bool rotateX = false, rotateY = false, rotateZ = false;
+//Tringulos do OBJ (x, y, z por vrtice), usados como oclusores
 vector<GLfloat> positions;
-vector<GLfloat> textureCoords;
-vector<GLfloat> normals;
-vector<GLfloat> ka;
-vector<GLfloat> ks;
-float ns;
+//Limites do OBJ carregado, no espao do modelo
+BoundingBox objBox;
+BoundingSphere objSphere;
 string objPath = "../../3D_Models/Suzanne/SuzanneTriTextured.obj";
-string mtlFile = "";
-string texturePath = "";
 string animation = "-0.6 -0.4 0.0 -0.4 -0.6 0.0 -0.2 -0.2 0.0 0.0 0.0 0.0 0.2 0.2 0.0 0.4 0.6 0.0 0.6 0.4 0.0";
 
 Camera camera;
+//Tecla P: seleciona a malha no centro da tela (raio contra a DynamicTree)
+bool pickRequested = false;
+//Tecla F (ou --prepass): pr-passagem de profundidade antes da iluminao
+bool depthPrepass = false;
+
+//Entrada lida na thread da OpenGL no comeo do quadro;  tudo o que a simulao recebe dela
+struct SimulationInput
+{
+	Camera camera;
+	bool pick;
+	double time;
+};
+
+//Resultado da simulao de um quadro: o envio s l daqui (e das malhas paradas do benchmark)
+struct FrameSnapshot
+{
+	Camera camera;
+	Frustum frustum;
+	Mesh suzanne;               //Cpia da Suzanne na posio do quadro
+	vector<Mesh*> visible;      //A Suzanne aparece como &suzanne deste snapshot
+	CullingStats culling;
+	OcclusionStats occlusion;
+	int treeHeight;
+	float treeAreaRatio;
+	FixedTimestepStats timestep;
+	vector<EntityDraw> entityDraws; //Entidades visveis, j com a model do quadro
+	double entityTime;              //Sistemas das entidades
+	vector<glm::mat4> hierarchyDraws; //Folhas visveis da hierarquia (matriz de mundo)
+	SceneGraphStats hierarchy;
+	string pickResult;          //Resultado da tecla P, impresso pela thread da OpenGL; vazio sem pedido
+	double inputTime;
+};
+
+//Todas as malhas (formato MeshVertex) e todas as curvas (s posio) vivem em duas arenas
+GeometryArena meshArena;
+GeometryArena curveArena;
 
 
 
 // Funo MAIN
-int main()
+// Cena de benchmark: --instances N desenha N cpias da Suzanne com InstancedMesh,
+// --naive desenha as mesmas N cpias como Mesh separadas, e --batched como Mesh
+// separadas entregues ao DrawBatcher (glMultiDrawElementsIndirect), para comparao.
+// --tree faz o culling percorrendo a DynamicTree em vez do teste SIMD sobre todas as esferas,
+// e --occlusion descarta tambm as malhas escondidas atrs das mais prximas (OcclusionCuller).
+// --gpu-cull troca o InstancedMesh pelo GpuCuller (culling em compute shader + desenho indireto),
+// e --gpu-occlusion testa tambm contra a pirmide de profundidade do quadro anterior.
+// --static marca as Mesh separadas do benchmark como estticas (StaticBatcher)
+// --prepass desenha a profundidade antes e ilumina s o fragmento visvel (GL_EQUAL)
+// --lights N espalha N luzes pontuais pela cena (forward clusterizado)
+// --target-ms T desenha em resoluo dinmica, ajustada para a GPU gastar T ms por quadro
+// --record-threads N grava os comandos das Mesh opacas em N threads (0 = um por ncleo)
+// --pipelined simula o prximo quadro em outra thread enquanto o atual  enviado (um quadro a mais de latncia)
+// --sim-hz H avana a animao H vezes por segundo, independente da taxa de quadros (padro 60)
+// --jobs N usa N threads no JobSystem alm da principal (0 = uma por ncleo)
+// --job-benchmark mede o JobSystem (envio, parallelFor, dependncias) e sai
+// --spin gira as cpias do --instances a cada quadro (matrizes do TransformBatch enviadas inteiras ao InstancedMesh)
+// --transform-benchmark compara as matrizes model do Mesh (glm, uma por vez) com o TransformBatch (SIMD) e sai
+// --entities N cria N Suzannes como entidades do EntityWorld (metade segue a curva), desenhadas pelo DrawBatcher
+// --hierarchy N cria uma hierarquia com N Suzannes em grupos; s o grupo preso  curva se move
+int main(int argc, char** argv)
 {
+	int benchmarkInstances = 0;
+	bool benchmarkNaive = false;
+	bool benchmarkBatched = false;
+	bool cullWithTree = false;
+	bool occlusionCulling = false;
+	bool gpuCulling = false;
+	bool gpuOcclusion = false;
+	bool staticScene = false;
+	int pointLightCount = 0;
+	double targetFrameTime = 0.0;
+	int recordThreads = 1;
+	bool pipelined = false;
+	double simulationRate = 60.0;
+	int jobWorkers = 0;
+	bool jobBenchmark = false;
+	bool transformBenchmark = false;
+	bool spinInstances = false;
+	int entityCount = 0;
+	int hierarchyCount = 0;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (string(argv[arg]) == "--instances" && arg + 1 < argc)
+			benchmarkInstances = atoi(argv[++arg]);
+		else if (string(argv[arg]) == "--naive")
+			benchmarkNaive = true;
+		else if (string(argv[arg]) == "--batched")
+			benchmarkNaive = benchmarkBatched = true;
+		else if (string(argv[arg]) == "--tree")
+			cullWithTree = true;
+		else if (string(argv[arg]) == "--occlusion")
+			occlusionCulling = true;
+		else if (string(argv[arg]) == "--gpu-cull")
+			gpuCulling = true;
+		else if (string(argv[arg]) == "--gpu-occlusion")
+			gpuCulling = gpuOcclusion = true;
+		else if (string(argv[arg]) == "--static")
+			benchmarkNaive = staticScene = true;
+		else if (string(argv[arg]) == "--lights" && arg + 1 < argc)
+			pointLightCount = atoi(argv[++arg]);
+		else if (string(argv[arg]) == "--target-ms" && arg + 1 < argc)
+			targetFrameTime = atof(argv[++arg]) / 1000.0;
+		else if (string(argv[arg]) == "--record-threads" && arg + 1 < argc)
+			recordThreads = atoi(argv[++arg]);
+		else if (string(argv[arg]) == "--prepass")
+			depthPrepass = true;
+		else if (string(argv[arg]) == "--pipelined")
+			pipelined = true;
+		else if (string(argv[arg]) == "--sim-hz" && arg + 1 < argc)
+			simulationRate = atof(argv[++arg]);
+		else if (string(argv[arg]) == "--jobs" && arg + 1 < argc)
+			jobWorkers = atoi(argv[++arg]);
+		else if (string(argv[arg]) == "--job-benchmark")
+			jobBenchmark = true;
+		else if (string(argv[arg]) == "--spin")
+			spinInstances = true;
+		else if (string(argv[arg]) == "--transform-benchmark")
+			transformBenchmark = true;
+		else if (string(argv[arg]) == "--entities" && arg + 1 < argc)
+			entityCount = atoi(argv[++arg]);
+		else if (string(argv[arg]) == "--hierarchy" && arg + 1 < argc)
+			hierarchyCount = atoi(argv[++arg]);
+	}
+
 	glfwInit();
 
+	jobSystem.initialize(jobWorkers);
+	if (jobBenchmark || transformBenchmark)
+	{
+		if (jobBenchmark)
+			runJobBenchmark();
+		if (transformBenchmark)
+			runTransformBenchmark();
+		jobSystem.destroy();
+		glfwTerminate();
+		return 0;
+	}
+
 	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Anderson Cossul", nullptr, nullptr);
 	glfwMakeContextCurrent(window);
 
@@ -87,6 +251,11 @@ int main()
 		cout << "Failed to initialize GLAD" << endl;
 	}
 
+	if (!loadGLExtensions((GLADloadproc)glfwGetProcAddress))
+	{
+		cout << "OpenGL 4.5 is required (Direct State Access)" << endl;
+	}
+
 	const GLubyte* renderer = glGetString(GL_RENDERER);
 	const GLubyte* version = glGetString(GL_VERSION);
 	cout << "Renderer: " << renderer << endl;
@@ -96,60 +265,699 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
+	//No benchmark o tempo de quadro no pode ficar preso ao vsync
+	if (benchmarkInstances > 0 || entityCount > 0 || hierarchyCount > 0)
+		glfwSwapInterval(0);
+
+	meshArena.initialize(sizeof(MeshVertex), 262144, 786432);
+	setupMeshVertexFormat(meshArena);
+	curveArena.initialize(sizeof(glm::vec3), 65536, 0);
+	curveArena.getVAO().setAttribute(0, 0, 3, GL_FLOAT, 0);
+
+	//1 MB por quadro ou o que as malhas do quadro precisam, 3 quadros em voo. Na RenderQueue cada
+	//malha usa um trecho alinhado para UBO; no DrawBatcher, uma matriz e um comando (os Mesh
+	//do --batched, as entidades e a hierarquia dividem o mesmo lote). O alinhamento da regio
+	//fica com o StreamBuffer, e a pr-passagem redesenha sem escrever de novo
+	GLsizeiptr queuedDraws = benchmarkNaive && !benchmarkBatched ? benchmarkInstances : 0;
+	GLsizeiptr batchedDraws = (benchmarkBatched ? benchmarkInstances : 0) + entityCount + hierarchyCount;
+	GLsizeiptr streamRegion = max((GLsizeiptr)1 << 20, (queuedDraws + 16) * uniformBufferAlignment()
+		+ batchedDraws * (GLsizeiptr)(sizeof(glm::mat4) + sizeof(DrawElementsIndirectCommand)));
+	frameStream.initialize(streamRegion, 3);
+	InstancedMesh::setDefaultInstanceTransform();
+
+	//Os arquivos da Suzanne so lidos nos jobs enquanto a thread da OpenGL compila o shader;
+	//Assets::wait atende os envios que a corrotina pede at ela terminar
+	Task<SuzanneAssets> suzanneLoad = loadSuzanne(objPath, "../../3D_Models/Suzanne/");
+	suzanneLoad.start();
 	Shader shader("../shaders/hello.vs", "../shaders/hello.fs");
-	loadOBJ(objPath);
-	loadMTL("../../3D_Models/Suzanne/" + mtlFile);
-	GLuint textureID = loadTexture("../../3D_Models/Suzanne/" + texturePath);
-	GLuint VAO = setupGeometry();
-
-	glUseProgram(shader.ID);
+	shader.validate("hello", HelloShader::uniforms, HelloShader::blocks);
+	SuzanneAssets suzanneAssets = Assets::wait(suzanneLoad);
+	const MaterialAsset& material = suzanneAssets.material;
+	GLuint textureID = suzanneAssets.texture.id;
+	int suzanneGeometry = suzanneAssets.mesh.geometry;
+	const vector<MeshVertex>& suzanneVertices = suzanneAssets.mesh.vertices;
+	const vector<GLuint>& suzanneIndices = suzanneAssets.mesh.indices;
+	positions = suzanneAssets.mesh.positions;
+	objBox = suzanneAssets.mesh.box;
+	objSphere = suzanneAssets.mesh.sphere;
+	glState.enable(GL_DEPTH_TEST);
+
+	shader.Use();
 
 	camera.initialize(&shader, width, height);
 
 	Mesh suzanne;
-	suzanne.initialize(VAO, positions.size() / 3, &shader, textureID);
+	suzanne.initialize(&meshArena, suzanneGeometry, &shader, textureID);
+	suzanne.setBounds(objBox, objSphere);
+
+	shader.set(HelloShader::ka, material.ka);
+	shader.set(HelloShader::kd, 0.5f);
+	shader.set(HelloShader::ks, material.ks);
+	shader.set(HelloShader::q, material.ns);
+	shader.set(HelloShader::colorBuffer, 0);
+
+	shader.set(HelloShader::lightPos, glm::vec3(-2.0f, 100.0f, 2.0f));
+	shader.set(HelloShader::lightColor, glm::vec3(1.0f, 1.0f, 1.0f));
+
+	vector<glm::mat4> benchmarkGrid = generateInstanceGrid(benchmarkInstances, 3.0f);
+	InstancedMesh benchmarkInstanced;
+	vector<Mesh> benchmarkMeshes;
+
+	Shader cullShader("../shaders/cull.comp");
+	cullShader.validate("cull", CullShader::uniforms);
+	Shader pyramidShader("../shaders/depth_pyramid.comp");
+	pyramidShader.validate("depth_pyramid", DepthPyramidShader::uniforms);
+	GpuCuller gpuCuller;
+	DepthPyramid depthPyramid;
+	if (gpuOcclusion)
+		depthPyramid.initialize(&pyramidShader, width, height);
+
+	//Transformaes das cpias em SoA; com --spin as rotaes mudam e as matrizes so recompostas todo quadro
+	TransformBatch instanceTransforms;
+	if (benchmarkInstances > 0 && !benchmarkNaive && gpuCulling)
+	{
+		gpuCuller.initialize(&cullShader, &shader, &meshArena, suzanneGeometry, benchmarkInstances, textureID);
+		gpuCuller.setObjects(benchmarkGrid, objSphere);
+	}
+	else if (benchmarkInstances > 0 && !benchmarkNaive)
+	{
+		benchmarkInstanced.initialize(&meshArena, suzanneGeometry, benchmarkInstances, &shader, textureID);
+		benchmarkInstanced.setInstances(benchmarkGrid);
+		if (spinInstances)
+			for (const glm::mat4& model : benchmarkGrid)
+				instanceTransforms.add(glm::vec3(model[3]), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+	}
+	else if (benchmarkInstances > 0)
+	{
+		benchmarkMeshes.resize(benchmarkInstances);
+		for (int m = 0; m < benchmarkInstances; m++)
+		{
+			benchmarkMeshes[m].initialize(&meshArena, suzanneGeometry, &shader, textureID, glm::vec3(benchmarkGrid[m][3]));
+			benchmarkMeshes[m].setBounds(objBox, objSphere);
+			benchmarkMeshes[m].setStatic(staticScene);
+		}
+	}
 
-	shader.setVec3("ka", ka[0], ka[1], ka[2]);
-	shader.setFloat("kd", 0.5);
-	shader.setVec3("ks", ks[0], ks[1], ks[2]);
-	shader.setFloat("q", ns);
+	//Luzes pontuais espalhadas pelo volume ocupado pelas malhas (ou em volta da origem)
+	Shader clusterShader("../shaders/light_cluster.comp");
+	clusterShader.validate("light_cluster", LightClusterShader::uniforms);
+	ClusteredLighting clusteredLighting;
+	if (pointLightCount > 0)
+	{
+		BoundingBox lightArea = { glm::vec3(-3.0f), glm::vec3(3.0f) };
+		for (const glm::mat4& model : benchmarkGrid)
+		{
+			lightArea.min = glm::min(lightArea.min, glm::vec3(model[3]) - 2.0f);
+			lightArea.max = glm::max(lightArea.max, glm::vec3(model[3]) + 2.0f);
+		}
+		clusteredLighting.initialize(&clusterShader, pointLightCount);
+		clusteredLighting.setLights(generateLights(pointLightCount, lightArea, 3.0f));
+		cout << "Forward clusterizado: " << clusteredLighting.getLightCount() << " luzes, " << ClusteredLighting::CLUSTER_COUNT << " clusters" << endl;
+	}
 
-	shader.setVec3("lightPos", -2.0f, 100.0f, 2.0f);
-	shader.setVec3("lightColor", 1.0f, 1.0f, 1.0f);
+	//Malhas estticas: geometria transformada e agrupada uma vez, sem culling nem desenho individual
+	StaticBatcher staticBatcher;
+	vector<Mesh*> dynamicMeshes;
+	for (Mesh& mesh : benchmarkMeshes)
+	{
+		if (mesh.isStatic())
+			staticBatcher.add(mesh, suzanneVertices, suzanneIndices);
+		else
+			dynamicMeshes.push_back(&mesh);
+	}
+	staticBatcher.build();
+	if (staticBatcher.getChunkCount() > 0)
+		cout << "Static batching: " << benchmarkMeshes.size() - dynamicMeshes.size() << " malhas em " << staticBatcher.getChunkCount() << " blocos" << endl;
+	if (benchmarkInstances > 0)
+		cout << "Benchmark: " << benchmarkInstances << " instancias (" << (benchmarkBatched ? "DrawBatcher" : staticScene ? "StaticBatcher" : benchmarkNaive ? "Mesh separadas" : gpuCulling ? "GpuCuller" : "InstancedMesh") << ")" << endl;
 
 	std::vector<glm::vec3> controlPoints = generateControlPointsSet(animation);
 
 	Bezier bezier;
 	bezier.setControlPoints(controlPoints);
 	bezier.setShader(&shader);
+	bezier.setArena(&curveArena);
 	bezier.generateCurve(100);
 	int nbCurvePoints = bezier.getNbCurvePoints();
 	int i = 0;
 
+	//A Suzanne anda um ponto da curva por passo fixo; o desenho fica entre os dois ltimos pontos
+	FixedTimestep simulationClock;
+	simulationClock.initialize(1.0 / max(simulationRate, 1.0));
+	glm::vec3 previousPoint = bezier.getPointOnCurve(0);
+	glm::vec3 currentPoint = previousPoint;
+
+	DrawBatcher batcher;
+	RenderQueue renderQueue;
+	renderQueue.setRecordThreads(recordThreads);
+
+	//Esfera de cada Mesh no culler: a Suzanne  o objeto 0, as malhas do benchmark (paradas) vm depois
+	FrustumCuller culler;
+	int suzanneCull = culler.add(suzanne.getWorldSphere());
+	int benchmarkCullBase = culler.getCount();
+	for (Mesh* mesh : dynamicMeshes)
+		culler.add(mesh->getWorldSphere());
+
+	//As mesmas malhas na rvore (userData = Mesh*); s a Suzanne se move
+	DynamicTree sceneTree;
+	int suzanneProxy = sceneTree.createProxy(suzanne.getWorldBox(), &suzanne);
+	for (Mesh* mesh : dynamicMeshes)
+		sceneTree.createProxy(mesh->getWorldBox(), mesh);
+	CullingStats treeStats = {};
+
+	//Entidades: todas com Transform, Renderable e Bounds; as mpares seguem a curva a partir da posio da grade
+	EntityWorld entities;
+	vector<glm::mat4> entityGrid = generateInstanceGrid(entityCount, 3.0f);
+	for (int e = 0; e < entityCount; e++)
+	{
+		glm::vec3 position = glm::vec3(entityGrid[e][3]);
+		TransformComponent transform = { position, 0.0f, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f), entityGrid[e] };
+		RenderableComponent renderable = { &shader, &meshArena, suzanneGeometry, textureID };
+		BoundsComponent bounds = { objSphere, transformSphere(objSphere, entityGrid[e]) };
+		if (e % 2 == 0)
+		{
+			entities.create(transform, renderable, bounds);
+			continue;
+		}
+		float start = (float)(e % nbCurvePoints);
+		glm::vec3 point = bezier.getPointOnCurve((int)start);
+		CurveFollowerComponent follower = { start, 0.5f + (e % 3) * 0.25f, position - bezier.getPointOnCurve(0), point, point };
+		entities.create(transform, renderable, bounds, follower);
+	}
+
+	//Hierarquia: grupos de HIERARCHY_GROUP folhas. O primeiro grupo fica preso a um n que segue a curva
+	//e gira; os outros ficam sob uma raiz parada, e update() no passa por eles depois do primeiro quadro
+	const int HIERARCHY_GROUP = 8;
+	SceneGraph sceneGraph;
+	FrustumCuller hierarchyCuller;
+	vector<int> hierarchyLeaves;            //n de cada folha (a folha  o ndice no hierarchyCuller)
+	vector<int> leafOfNode;                 //-1 nos ns internos
+	float carrierAngle = 0.0f;
+	int carrier = sceneGraph.createNode(SceneGraph::NO_PARENT, bezier.getPointOnCurve(0), glm::vec3(1.0f), 0.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+	int staticRoot = sceneGraph.createNode(SceneGraph::NO_PARENT);
+	vector<glm::mat4> hierarchyGrid = generateInstanceGrid(hierarchyCount, 3.0f);
+	for (int first = 0; first < hierarchyCount; first += HIERARCHY_GROUP)
+	{
+		//O grupo preso  curva orbita em volta dela; os parados ficam na grade
+		glm::vec3 groupPosition = first == 0 ? glm::vec3(0.0f) : glm::vec3(hierarchyGrid[first][3]);
+		int group = sceneGraph.createNode(first == 0 ? carrier : staticRoot, groupPosition);
+		for (int leaf = first; leaf < min(first + HIERARCHY_GROUP, hierarchyCount); leaf++)
+		{
+			glm::vec3 position = first == 0 ? glm::vec3(3.0f * cos(leaf * 0.785f), 0.0f, 3.0f * sin(leaf * 0.785f))
+				: glm::vec3(hierarchyGrid[leaf][3]) - groupPosition;
+			int node = sceneGraph.createNode(group, position, glm::vec3(0.5f));
+			leafOfNode.resize(node + 1, -1);
+			leafOfNode[node] = hierarchyCuller.add(objSphere);
+			hierarchyLeaves.push_back(node);
+		}
+	}
+	leafOfNode.resize(sceneGraph.getNodeCount(), -1);
+
+	//As malhas visveis mais prximas viram oclusores (a geometria do OBJ, com a model de cada uma)
+	const int OCCLUDER_COUNT = 8;
+	OcclusionCuller occlusion;
+	occlusion.initialize(256, 256);
+
+	//Simulao de um quadro: avana os passos fixos, pe a Suzanne no ponto interpolado e faz o culling e o picking.
+	// dona da Suzanne "de verdade", da rvore, do culler e do OcclusionCuller; no chama a OpenGL
+	//e pode rodar em outra thread. Tudo o que o envio precisa sai no snapshot.
+	auto simulate = [&](FrameSnapshot& snapshot, const SimulationInput& input)
+		{
+			const Camera& view = input.camera;
+
+			int steps = simulationClock.advance(input.time);
+			for (int step = 0; step < steps; step++)
+			{
+				i = (i + 1) % nbCurvePoints;
+				//Na volta para o comeo da curva a Suzanne salta, como antes: no interpola entre as pontas
+				previousPoint = i == 0 ? bezier.getPointOnCurve(i) : currentPoint;
+				currentPoint = bezier.getPointOnCurve(i);
+			}
+			glm::vec3 pointOnCurve = glm::mix(previousPoint, currentPoint, simulationClock.getAlpha());
+			glm::vec3 displacement = pointOnCurve - suzanne.getPosition();
+			suzanne.updatePosition(pointOnCurve);
+			sceneTree.moveProxy(suzanneProxy, suzanne.getWorldBox(), displacement);
+			snapshot.suzanne = suzanne;
+
+			Frustum frustum = Frustum::fromMatrix(view.getProjectionMatrix() * view.getViewMatrix());
+
+			snapshot.hierarchyDraws.clear();
+			if (hierarchyCount > 0)
+			{
+				//S o n da curva muda; as esferas do culler acompanham s os ns que mudaram
+				carrierAngle = fmod(carrierAngle + steps * 2.0f, 360.0f);
+				sceneGraph.setPosition(carrier, pointOnCurve);
+				sceneGraph.setRotation(carrier, carrierAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+				sceneGraph.update();
+				for (int node : sceneGraph.getChanged())
+					if (leafOfNode[node] >= 0)
+						hierarchyCuller.set(leafOfNode[node], transformSphere(objSphere, sceneGraph.getWorldMatrix(node)));
+				hierarchyCuller.cull(frustum);
+				for (size_t leaf = 0; leaf < hierarchyLeaves.size(); leaf++)
+					if (hierarchyCuller.isVisible((int)leaf))
+						snapshot.hierarchyDraws.push_back(sceneGraph.getWorldMatrix(hierarchyLeaves[leaf]));
+				hierarchyCuller.endFrame();
+			}
+			snapshot.hierarchy = sceneGraph.lastFrame();
+
+			snapshot.entityDraws.clear();
+			snapshot.entityTime = 0.0;
+			if (entities.getEntityCount() > 0)
+			{
+				double start = glfwGetTime();
+				Systems::followCurves(entities, bezier.getCurvePoints(), steps, simulationClock.getAlpha());
+				Systems::composeTransforms(entities);
+				Systems::updateBounds(entities);
+				Systems::collectVisible(entities, frustum, snapshot.entityDraws);
+				snapshot.entityTime = glfwGetTime() - start;
+			}
+			vector<Mesh*>& visibleMeshes = snapshot.visible;
+			visibleMeshes.clear();
+			if (cullWithTree)
+			{
+				double start = glfwGetTime();
+				sceneTree.query(frustum, [&](int proxy) { visibleMeshes.push_back((Mesh*)sceneTree.getUserData(proxy)); });
+				treeStats.tested = sceneTree.getProxyCount();
+				treeStats.culled = treeStats.tested - (unsigned int)visibleMeshes.size();
+				treeStats.time = glfwGetTime() - start;
+			}
+			else
+			{
+				culler.set(suzanneCull, suzanne.getWorldSphere());
+				culler.cull(frustum);
+				if (culler.isVisible(suzanneCull))
+					visibleMeshes.push_back(&suzanne);
+				for (size_t m = 0; m < dynamicMeshes.size(); m++)
+					if (culler.isVisible(benchmarkCullBase + (int)m))
+						visibleMeshes.push_back(dynamicMeshes[m]);
+			}
+
+			if (occlusionCulling)
+			{
+				glm::vec3 eye = view.getPosition();
+				auto closer = [&](Mesh* a, Mesh* b) { return glm::length(a->getPosition() - eye) < glm::length(b->getPosition() - eye); };
+				size_t occluders = min(visibleMeshes.size(), (size_t)OCCLUDER_COUNT);
+				partial_sort(visibleMeshes.begin(), visibleMeshes.begin() + occluders, visibleMeshes.end(), closer);
+
+				occlusion.beginFrame(view.getProjectionMatrix() * view.getViewMatrix());
+				for (size_t o = 0; o < occluders; o++)
+					occlusion.addOccluder(positions, visibleMeshes[o]->getModelMatrix());
+				occlusion.render();
+
+				//Os oclusores so desenhados sempre; o resto s se alguma parte da caixa aparece
+				visibleMeshes.erase(remove_if(visibleMeshes.begin() + occluders, visibleMeshes.end(),
+					[&](Mesh* mesh) { return !occlusion.isVisible(mesh->getWorldBox()); }), visibleMeshes.end());
+				occlusion.endFrame();
+			}
+
+			snapshot.pickResult.clear();
+			if (input.pick)
+			{
+				//A rvore s descarta pelas caixas gordas; o teste exato  com a esfera da malha
+				Mesh* picked = nullptr;
+				glm::vec3 origin = view.getPosition();
+				glm::vec3 direction = glm::normalize(view.getFront());
+				sceneTree.rayCast(origin, direction, view.getFarPlane(), [&](int proxy, float maxDistance)
+					{
+						Mesh* mesh = (Mesh*)sceneTree.getUserData(proxy);
+						BoundingSphere sphere = mesh->getWorldSphere();
+						glm::vec3 toCenter = sphere.center - origin;
+						float along = glm::dot(toCenter, direction);
+						float distance2 = glm::dot(toCenter, toCenter) - along * along;
+						if (distance2 > sphere.radius * sphere.radius)
+							return -1.0f;
+						float hit = along - sqrt(sphere.radius * sphere.radius - distance2);
+						if (hit < 0.0f || hit > maxDistance)
+							return -1.0f;
+						picked = mesh;
+						return hit;
+					});
+				if (picked == &suzanne)
+					snapshot.pickResult = "Suzanne";
+				else if (picked)
+					snapshot.pickResult = "malha " + to_string(picked - benchmarkMeshes.data()) + " do benchmark";
+				else
+					snapshot.pickResult = "nenhuma";
+			}
+
+			//A Suzanne que o envio desenha  a cpia, que no muda enquanto o prximo quadro  simulado
+			replace(visibleMeshes.begin(), visibleMeshes.end(), &suzanne, &snapshot.suzanne);
+
+			culler.endFrame();
+			snapshot.camera = view;
+			snapshot.frustum = frustum;
+			snapshot.culling = cullWithTree ? treeStats : culler.lastFrame();
+			snapshot.occlusion = occlusion.lastFrame();
+			snapshot.treeHeight = sceneTree.getHeight();
+			snapshot.treeAreaRatio = sceneTree.getAreaRatio();
+			snapshot.timestep = simulationClock.lastFrame();
+			snapshot.inputTime = input.time;
+		};
+
+	//Dois snapshots: o envio l snapshots[front] enquanto a simulao escreve no outro
+	FrameSnapshot snapshots[2];
+	int front = 0;
+	FramePipeline pipeline;
+	pipeline.initialize(pipelined);
+	auto sampleInput = [&]()
+		{
+			SimulationInput input = { camera, pickRequested, glfwGetTime() };
+			pickRequested = false;
+			return input;
+		};
+	//Em pipeline o primeiro quadro j precisa de um snapshot pronto
+	if (pipeline.isThreaded())
+	{
+		SimulationInput input = sampleInput();
+		pipeline.kick([&simulate, &snapshots, input]() { simulate(snapshots[1], input); });
+	}
+
+	PipelineStatistics pipelineStats;
+	pipelineStats.initialize();
+
+	RenderGraph frameGraph;
+
+	DynamicResolution resolution;
+	if (targetFrameTime > 0.0)
+		resolution.initialize(width, height, targetFrameTime);
+
+	double lastReport = glfwGetTime();
+	int framesSinceReport = 0;
+	//Tempo por quadro para os envios das corrotinas de carregamento (s)
+	const double ASSET_UPLOAD_BUDGET = 0.002;
 
 	while (!glfwWindowShouldClose(window))
 	{
 		glfwPollEvents();
+		glState.beginFrame();
+		frameStream.beginFrame();
+		Assets::pump(ASSET_UPLOAD_BUDGET);
+
+		//Sem pipeline o quadro  simulado aqui; em pipeline s troca pelo snapshot que a outra thread terminou
+		//e entrega a ela o prximo, com a entrada lida agora
+		SimulationInput input = sampleInput();
+		FrameSnapshot* back = &snapshots[1 - front];
+		if (!pipeline.isThreaded())
+			pipeline.kick([&simulate, back, &input]() { simulate(*back, input); });
+		pipeline.wait();
+		front = 1 - front;
+		const FrameSnapshot& frame = snapshots[front];
+		if (pipeline.isThreaded())
+		{
+			back = &snapshots[1 - front];
+			pipeline.kick([&simulate, back, input]() { simulate(*back, input); });
+		}
+
+		//A simulao pode estar em outra thread: s esta imprime
+		if (!frame.pickResult.empty())
+			cout << "Selecionada: " << frame.pickResult << endl;
 
+		//Estatsticas do quadro anterior, uma vez por segundo
+		if (glfwGetTime() - lastReport >= 1.0)
+		{
+			double elapsed = glfwGetTime() - lastReport;
+			lastReport = glfwGetTime();
+			cout << "Quadro: " << elapsed * 1000.0 / max(framesSinceReport, 1) << " ms (" << framesSinceReport / elapsed << " fps)" << endl;
+			framesSinceReport = 0;
+			if (resolution.isEnabled())
+				cout << "Resolucao: " << resolution.getScale() * 100.0f << "% (" << resolution.lastFrame().width << "x" << resolution.lastFrame().height
+					<< "), GPU " << resolution.lastFrame().gpuTime * 1000.0 << " ms, alvo " << targetFrameTime * 1000.0 << " ms" << endl;
+			cout << "Render graph: " << frameGraph.lastFrame().passes << " passos (" << frameGraph.lastFrame().culled << " descartados), "
+				<< frameGraph.lastFrame().barriers << " barreiras, transientes " << frameGraph.lastFrame().transientResources << " em "
+				<< frameGraph.lastFrame().physicalResources << " recursos, pico " << frameGraph.lastFrame().peakTransientBytes / 1024 << " KB (sem aliasing "
+				<< frameGraph.lastFrame().transientBytes / 1024 << " KB)" << endl;
+			if (Assets::getPendingUploads() > 0)
+				cout << "Assets: " << Assets::getPendingUploads() << " envios esperando a thread da OpenGL" << endl;
+			cout << "GL state: " << glState.lastFrame().issued << " chamadas, " << glState.lastFrame().skipped << " redundantes descartadas" << endl;
+			cout << "Jobs:";
+			for (size_t t = 0; t < jobSystem.lastFrame().size(); t++)
+			{
+				const JobWorkerStats& worker = jobSystem.lastFrame()[t];
+				cout << " " << (t == 0 ? string("principal") : to_string(t)) << " " << worker.utilization * 100.0f << "% (" << worker.jobs << ", " << worker.steals << " roubados)";
+			}
+			cout << endl;
+			if (pipeline.isThreaded())
+				cout << "Pipeline: simulacao " << pipeline.lastFrame().simulationTime * 1000.0 << " ms, espera " << pipeline.lastFrame().waitTime * 1000.0
+					<< " ms, latencia " << pipeline.lastFrame().latency * 1000.0 << " ms" << endl;
+			else
+				cout << "Simulacao: " << pipeline.lastFrame().simulationTime * 1000.0 << " ms, latencia " << pipeline.lastFrame().latency * 1000.0 << " ms" << endl;
+			cout << "Passo fixo: " << frame.timestep.steps << " passos de " << simulationClock.getStep() * 1000.0 << " ms no quadro, alpha "
+				<< frame.timestep.alpha << ", " << frame.timestep.droppedTime * 1000.0 << " ms descartados" << endl;
+			const CullingStats& cullStats = frame.culling;
+			cout << "Culling" << (cullWithTree ? " (arvore)" : "") << ": " << cullStats.culled << " de " << cullStats.tested << " malhas descartadas em "
+				<< cullStats.time * 1000.0 << " ms" << endl;
+			if (occlusionCulling)
+				cout << "Oclusao (" << OcclusionCuller::getRasterPath() << "): " << frame.occlusion.culled << " de " << frame.occlusion.tested << " malhas escondidas, "
+					<< frame.occlusion.occluderTriangles << " triangulos oclusores, raster " << frame.occlusion.rasterTime * 1000.0
+					<< " ms, testes " << frame.occlusion.testTime * 1000.0 << " ms" << endl;
+			if (cullWithTree)
+				cout << "Arvore: altura " << frame.treeHeight << ", razao de area " << frame.treeAreaRatio << endl;
+			cout << "Fila: " << renderQueue.lastFrame().draws << " desenhos, trocas de programa/material/textura/VAO: "
+				<< renderQueue.lastFrame().programChanges << "/" << renderQueue.lastFrame().materialChanges << "/"
+				<< renderQueue.lastFrame().textureChanges << "/" << renderQueue.lastFrame().vertexArrayChanges << endl;
+			if (renderQueue.getRecordThreads() > 1)
+				cout << "Gravacao: " << renderQueue.getRecordThreads() << " threads, " << renderQueue.lastFrame().recordedCommands << " comandos, gravacao "
+					<< renderQueue.lastFrame().recordTime * 1000.0 << " ms, execucao " << renderQueue.lastFrame().replayTime * 1000.0 << " ms" << endl;
+			//Leitura sncrona do contador, s uma vez por segundo
+			if (gpuCuller.getObjectCount() > 0)
+				cout << "GPU culling: " << gpuCuller.readVisibleCount() << " de " << gpuCuller.getObjectCount() << " instancias visiveis" << endl;
+			if (staticBatcher.getChunkCount() > 0)
+				cout << "Static batching: " << staticBatcher.lastFrame().drawn << " de " << staticBatcher.lastFrame().chunks << " blocos desenhados" << endl;
+			if (pipelineStats.isSupported())
+				cout << "Fragmentos" << (depthPrepass ? " (pre-passagem)" : "") << ": " << pipelineStats.lastFrame().shadingFragments << " iluminados, "
+					<< pipelineStats.lastFrame().prepassFragments << " so de profundidade, " << pipelineStats.lastFrame().pending << " leituras atrasadas" << endl;
+			if (clusteredLighting.getLightCount() > 0)
+			{
+				//Leitura sncrona das contagens, s uma vez por segundo
+				ClusterStats lightStats = clusteredLighting.readStats();
+				cout << "Clusters: " << lightStats.clusters << " de " << ClusteredLighting::CLUSTER_COUNT << " com luz, media " << lightStats.averagePerCluster
+					<< " luzes, maximo " << lightStats.maxPerCluster << ", " << lightStats.saturated << " cheios" << endl;
+			}
+			if (hierarchyCount > 0)
+				cout << "Hierarquia: " << frame.hierarchy.nodes << " nos, " << frame.hierarchy.dirtyRoots << " marcados, " << frame.hierarchy.updated
+					<< " matrizes recalculadas em " << frame.hierarchy.time * 1000.0 << " ms, " << frame.hierarchyDraws.size() << " de "
+					<< hierarchyCount << " folhas visiveis" << endl;
+			if (entities.getEntityCount() > 0)
+				cout << "Entidades: " << frame.entityDraws.size() << " de " << entities.getEntityCount() << " visiveis, " << entities.getArchetypeCount()
+					<< " arquetipos, " << entities.getChunkCount() << " chunks, sistemas " << frame.entityTime * 1000.0 << " ms" << endl;
+			if (instanceTransforms.getCount() > 0)
+				cout << "Instancias: " << instanceTransforms.lastFrame().objects << " matrizes compostas em "
+					<< instanceTransforms.lastFrame().time * 1000.0 << " ms" << endl;
+			cout << "Batcher: " << batcher.lastFrame().draws << " malhas em " << batcher.lastFrame().batches << " multi-draws"
+				<< (batcher.lastFrame().dropped > 0 ? ", " + to_string(batcher.lastFrame().dropped) + " descartadas (frameStream cheio)" : string()) << endl;
+			cout << "Stream: " << frameStream.lastFrame().bytesUsed << " bytes, " << frameStream.lastFrame().waits << " esperas ("
+				<< frameStream.lastFrame().waitTime * 1000.0 << " ms), " << frameStream.getTotalWaits() << " esperas no total, "
+				<< frameStream.lastFrame().overflows << " alocacoes recusadas" << endl;
+		}
+
+		resolution.beginFrame();
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		glLineWidth(10);
 		glPointSize(20);
 
-		camera.update();
+		//A cmera do quadro  a que a simulao usou, no a que a entrada j moveu
+		Camera view = frame.camera;
+		view.update();
 
-		glm::vec3 pointOnCurve = bezier.getPointOnCurve(i);
-		suzanne.updatePosition(pointOnCurve);
-		suzanne.update();
-		suzanne.draw();
+		renderQueue.setView(view.getViewMatrix(), view.getNearPlane(), view.getFarPlane());
 
-		i = (i + 1) % nbCurvePoints;
+		//Matrizes, comandos indiretos e listas gravadas vo para o frameStream uma vez s;
+		//a pr-passagem e a iluminao s repetem os desenhos
+		StreamAllocation instancedData = {};
+		if (instanceTransforms.getCount() > 0)
+		{
+			//Um seno e um cosseno por quadro: metade das cpias gira para cada lado
+			glm::quat spin = glm::angleAxis((float)fmod(frame.inputTime, 2.0 * glm::pi<double>()), glm::vec3(0.0f, 1.0f, 0.0f));
+			glm::quat reverse = glm::conjugate(spin);
+			for (int k = 0; k < instanceTransforms.getCount(); k++)
+				instanceTransforms.setRotation(k, k % 2 == 0 ? spin : reverse);
+			instanceTransforms.compose();
+			benchmarkInstanced.setInstances(instanceTransforms.getMatrices(), instanceTransforms.getCount());
+		}
+		if (gpuCuller.getObjectCount() == 0 && benchmarkInstances > 0 && !benchmarkNaive)
+			instancedData = Mesh::writeObjectData(benchmarkInstanced.getModelMatrix());
+		for (Mesh* mesh : frame.visible)
+		{
+			if (benchmarkBatched && mesh != &frame.suzanne && mesh->submit(batcher))
+				continue;
+			renderQueue.push(mesh);
+		}
+		for (const EntityDraw& draw : frame.entityDraws)
+			batcher.add(draw.renderable.shader, draw.renderable.arena, draw.renderable.allocation, draw.renderable.textureID, draw.model);
+		for (const glm::mat4& model : frame.hierarchyDraws)
+			batcher.add(&shader, &meshArena, suzanneGeometry, textureID, model);
+		renderQueue.prepare();
+		batcher.prepare();
+
+		//Tudo o que  opaco; chamado uma ou duas vezes por quadro
+		auto drawScene = [&]()
+			{
+				if (gpuCuller.getObjectCount() > 0)
+					gpuCuller.draw();
+				else if (benchmarkInstances > 0 && !benchmarkNaive)
+				{
+					Mesh::bindObjectData(instancedData);
+					benchmarkInstanced.draw();
+				}
+				renderQueue.draw();
+				batcher.draw();
+				staticBatcher.draw(frame.frustum);
+			};
+
+		//Passos do quadro; a ordem de execuo e as barreiras saem das leituras e escritas declaradas
+		frameGraph.reset();
+		GraphHandle backbuffer = frameGraph.importTexture("backbuffer", 0);
+		GraphHandle sceneColor = resolution.isEnabled() ? frameGraph.importTexture("scene-color", resolution.getColorTexture()) : backbuffer;
+		GraphHandle sceneDepth = frameGraph.importTexture("scene-depth", resolution.getDepthTexture());
+		GraphHandle lightClusters = frameGraph.importBuffer("light-clusters", clusteredLighting.getClusterBuffer());
+		GraphHandle culledInstances = frameGraph.importBuffer("culled-instances", gpuCuller.getCommandBuffer());
+		GraphHandle pyramid = frameGraph.importTexture("depth-pyramid", depthPyramid.getTexture());
+		frameGraph.markOutput(backbuffer);
+		if (gpuOcclusion)
+			frameGraph.markOutput(pyramid);
+
+		if (clusteredLighting.getLightCount() > 0)
+			frameGraph.addPass("light-clusters",
+				[&](RenderGraph::PassBuilder& pass) { lightClusters = pass.write(lightClusters, GraphAccess::Storage); },
+				[&](RenderGraph&) { clusteredLighting.update(view.getViewMatrix(), view.getProjectionMatrix(), view.getNearPlane(), view.getFarPlane()); });
+
+		if (gpuCuller.getObjectCount() > 0)
+			frameGraph.addPass("gpu-cull",
+				[&](RenderGraph::PassBuilder& pass)
+				{
+					//A pirmide lida aqui  a do quadro anterior
+					if (gpuOcclusion)
+						pass.read(pyramid, GraphAccess::Sampled);
+					culledInstances = pass.write(culledInstances, GraphAccess::Storage);
+				},
+				[&](RenderGraph&) { gpuCuller.cull(view.getProjectionMatrix() * view.getViewMatrix(), gpuOcclusion ? &depthPyramid : nullptr); });
+
+		//Os dois passos de desenho leem o mesmo resultado do culling
+		auto readSceneInputs = [&](RenderGraph::PassBuilder& pass)
+			{
+				if (gpuCuller.getObjectCount() > 0)
+				{
+					pass.read(culledInstances, GraphAccess::Indirect);
+					pass.read(culledInstances, GraphAccess::VertexAttribute);
+				}
+			};
+
+		if (depthPrepass)
+			frameGraph.addPass("depth-prepass",
+				[&](RenderGraph::PassBuilder& pass)
+				{
+					readSceneInputs(pass);
+					sceneDepth = pass.write(sceneDepth, GraphAccess::Framebuffer);
+				},
+				[&](RenderGraph&)
+				{
+					//Mesmo programa e mesmo vertex shader nas duas passadas: a profundidade bate exatamente no GL_EQUAL
+					shader.Use();
+					shader.set(HelloShader::depthOnly, true);
+					glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+					pipelineStats.begin(RenderPass::DepthPrepass);
+					drawScene();
+					pipelineStats.end();
+					glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+					shader.Use();
+					shader.set(HelloShader::depthOnly, false);
+				});
+
+		frameGraph.addPass("shading",
+			[&](RenderGraph::PassBuilder& pass)
+			{
+				readSceneInputs(pass);
+				if (clusteredLighting.getLightCount() > 0)
+					pass.read(lightClusters, GraphAccess::Storage);
+				pass.read(sceneDepth, GraphAccess::Framebuffer);
+				sceneDepth = pass.write(sceneDepth, GraphAccess::Framebuffer);
+				sceneColor = pass.write(sceneColor, GraphAccess::Framebuffer);
+			},
+			[&](RenderGraph&)
+			{
+				if (clusteredLighting.getLightCount() > 0)
+					clusteredLighting.bind(&shader, resolution.isEnabled() ? resolution.getRenderWidth() : width,
+						resolution.isEnabled() ? resolution.getRenderHeight() : height);
+				//A iluminao roda uma vez por pixel: s passa o fragmento que deixou a profundidade
+				if (depthPrepass)
+				{
+					glDepthFunc(GL_EQUAL);
+					glDepthMask(GL_FALSE);
+				}
+				pipelineStats.begin(RenderPass::Shading);
+				drawScene();
+				pipelineStats.end();
+				if (depthPrepass)
+				{
+					glDepthFunc(GL_LESS);
+					glDepthMask(GL_TRUE);
+				}
+			});
+
+		//Cpia da profundidade: transiente, s existe entre a cpia e a reduo
+		GraphHandle depthCopy = -1;
+		if (gpuOcclusion)
+		{
+			frameGraph.addPass("depth-copy",
+				[&](RenderGraph::PassBuilder& pass)
+				{
+					pass.read(sceneDepth, GraphAccess::Transfer);
+					depthCopy = pass.createTexture("depth-copy", GraphTextureDesc{ depthPyramid.getWindowWidth(), depthPyramid.getWindowHeight(), GL_DEPTH24_STENCIL8, 1 });
+				},
+				[&](RenderGraph& graph)
+				{
+					depthPyramid.copyDepth(graph.getFramebuffer(depthCopy), resolution.getFramebuffer(), resolution.getRenderWidth(), resolution.getRenderHeight());
+				});
+			frameGraph.addPass("depth-pyramid",
+				[&](RenderGraph::PassBuilder& pass)
+				{
+					pass.read(depthCopy, GraphAccess::Sampled);
+					pyramid = pass.write(pyramid, GraphAccess::Image);
+				},
+				[&](RenderGraph& graph) { depthPyramid.build(graph.getTexture(depthCopy)); });
+		}
+
+		if (resolution.isEnabled())
+			frameGraph.addPass("upscale",
+				[&](RenderGraph::PassBuilder& pass)
+				{
+					pass.read(sceneColor, GraphAccess::Transfer);
+					backbuffer = pass.write(backbuffer, GraphAccess::Framebuffer);
+				},
+				[&](RenderGraph&) { resolution.upscale(); });
+
+		frameGraph.compile();
+		frameGraph.execute();
 
+		resolution.endFrame();
+
+		staticBatcher.endFrame();
+		pipelineStats.endFrame();
+		frameStream.endFrame();
 		glfwSwapBuffers(window);
+		pipeline.endFrame(glfwGetTime() - frame.inputTime);
+		jobSystem.endFrame();
+		framesSinceReport++;
 	}
 
-	glDeleteVertexArrays(1, &VAO);
+	pipeline.destroy();
+	bezier.destroy();
+	benchmarkInstanced.destroy();
+	gpuCuller.destroy();
+	depthPyramid.destroy();
+	staticBatcher.destroy();
+	clusteredLighting.destroy();
+	resolution.destroy();
+	frameGraph.destroy();
+	pipelineStats.destroy();
+	Mesh::destroyIdentityObjectData();
+	frameStream.destroy();
+	jobSystem.destroy();
+	meshArena.destroy();
+	curveArena.destroy();
+	destroyTexture(textureID);
 	glfwTerminate();
 	return 0;
 }
@@ -157,6 +965,11 @@ int main()
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
 	camera.move(window, key, action);
+
+	if (key == GLFW_KEY_P && action == GLFW_PRESS)
+		pickRequested = true;
+	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		depthPrepass = !depthPrepass;
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
@@ -164,208 +977,186 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 	camera.rotate(window, xpos, ypos);
 }
 
-// Esta funo est bastante harcoded - objetivo  criar os buffers que armazenam a 
-// geometria de um tringulo
-// Apenas atributo coordenada nos vrtices
-// 1 VBO com as coordenadas, VAO com apenas 1 ponteiro para atributo
-// A funo retorna o identificador do VAO
-int setupGeometry()
+// Suzanne: o OBJ nomeia o MTL, que nomeia a textura. Cada etapa l e decodifica
+// em um job e s volta para a thread da OpenGL para enviar a malha e a textura
+Task<SuzanneAssets> loadSuzanne(string objPath, string directory)
 {
-	GLuint VAO, VBO[3];
-
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(2, VBO);
-
-	glBindVertexArray(VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-	glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(GLfloat), positions.data(), GL_STATIC_DRAW);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-	glBufferData(GL_ARRAY_BUFFER, textureCoords.size() * sizeof(GLfloat), textureCoords.data(), GL_STATIC_DRAW);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(1);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
-	glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(GLfloat), normals.data(), GL_STATIC_DRAW);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(2);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	glEnable(GL_DEPTH_TEST);
-
-	return VAO;
-
+	SuzanneAssets assets;
+	assets.mesh = co_await Assets::loadMesh(objPath, &meshArena);
+	assets.material = co_await Assets::loadMaterial(directory + assets.mesh.materialFile);
+	assets.texture = co_await Assets::loadTexture(directory + assets.material.texturePath);
+	co_return assets;
 }
 
-void loadOBJ(string path)
-{
-	vector<glm::vec3> vertexIndices;
-	vector<glm::vec2> textureIndices;
-	vector<glm::vec3> normalIndices;
+std::vector<glm::vec3> generateControlPointsSet(const std::string& input) {
+	std::vector<glm::vec3> controlPoints;
+	std::istringstream iss(input);
+	float x, y, z;
 
-	ifstream file(path);
-	if (!file.is_open())
-	{
-		cerr << "Failed to open file: " << path << endl;
-		return;
+	while (iss >> x >> y >> z) {
+		controlPoints.push_back(glm::vec3(x, y, z));
 	}
 
-	string line;
-	while (getline(file, line))
-	{
-		istringstream iss(line);
-		string prefix;
-		iss >> prefix;
+	return controlPoints;
+}
 
-		if (prefix == "mtllib")
-		{
-			iss >> mtlFile;
-		}
-		else if (prefix == "v")
-		{
-			float x, y, z;
-			iss >> x >> y >> z;
-			vertexIndices.push_back(glm::vec3(x, y, z));
-		}
-		else if (prefix == "vt")
-		{
-			float u, v;
-			iss >> u >> v;
-			textureIndices.push_back(glm::vec2(u, v));
-		}
-		else if (prefix == "vn")
-		{
-			float x, y, z;
-			iss >> x >> y >> z;
-			normalIndices.push_back(glm::vec3(x, y, z));
-		}
-		else if (prefix == "f")
+// Grade (aproximadamente cbica) de n matrizes model,  frente da cmera
+vector<glm::mat4> generateInstanceGrid(int n, float spacing)
+{
+	vector<glm::mat4> grid(max(n, 0));
+	int side = (int)ceil(cbrt((double)n));
+	glm::vec3 origin(-0.5f * spacing * (side - 1), -0.5f * spacing * (side - 1), -5.0f);
+	jobSystem.parallelFor(n, 4096, [&](int begin, int end)
 		{
-			string v1, v2, v3;
-			iss >> v1 >> v2 >> v3;
-
-			glm::ivec3 vIndices, tIndices, nIndices;
-			istringstream(v1.substr(0, v1.find('/'))) >> vIndices.x;
-			istringstream(v1.substr(v1.find('/') + 1, v1.rfind('/') - v1.find('/') - 1)) >> tIndices.x;
-			istringstream(v1.substr(v1.rfind('/') + 1)) >> nIndices.x;
-			istringstream(v2.substr(0, v2.find('/'))) >> vIndices.y;
-			istringstream(v2.substr(v2.find('/') + 1, v2.rfind('/') - v2.find('/') - 1)) >> tIndices.y;
-			istringstream(v2.substr(v2.rfind('/') + 1)) >> nIndices.y;
-			istringstream(v3.substr(0, v3.find('/'))) >> vIndices.z;
-			istringstream(v3.substr(v3.find('/') + 1, v3.rfind('/') - v3.find('/') - 1)) >> tIndices.z;
-			istringstream(v3.substr(v3.rfind('/') + 1)) >> nIndices.z;
-
-			for (int i = 0; i < 3; i++)
+			for (int k = begin; k < end; k++)
 			{
-				const glm::vec3& vertex = vertexIndices[vIndices[i] - 1];
-				const glm::vec2& texture = textureIndices[tIndices[i] - 1];
-				const glm::vec3& normal = normalIndices[nIndices[i] - 1];
-
-				positions.push_back(vertex.x);
-				positions.push_back(vertex.y);
-				positions.push_back(vertex.z);
-				textureCoords.push_back(texture.x);
-				textureCoords.push_back(texture.y);
-				normals.push_back(normal.x);
-				normals.push_back(normal.y);
-				normals.push_back(normal.z);
+				glm::vec3 cell(k % side, (k / side) % side, -(k / (side * side)));
+				grid[k] = glm::translate(glm::mat4(1), origin + cell * spacing);
 			}
-		}
-	}
-
-	file.close();
+		});
+	return grid;
 }
 
-
-void loadMTL(string path)
+// Luzes com posio e cor sorteadas (semente fixa, a cena  a mesma em toda execuo)
+vector<PointLight> generateLights(int n, const BoundingBox& area, float radius)
 {
-	string line, readValue;
-	ifstream mtlFile(path);
-
-	while (!mtlFile.eof())
+	vector<PointLight> lights;
+	srand(1);
+	auto random = []() { return (float)rand() / RAND_MAX; };
+	for (int l = 0; l < n; l++)
 	{
-		getline(mtlFile, line);
-
-		istringstream iss(line);
-
-		if (line.find("map_Kd") == 0)
-		{
-			iss >> readValue >> texturePath;
-		}
-		else if (line.find("Ka") == 0)
-		{
-			float ka1, ka2, ka3;
-			iss >> readValue >> ka1 >> ka2 >> ka3;
-			ka.push_back(ka1);
-			ka.push_back(ka2);
-			ka.push_back(ka3);
-		}
-		else if (line.find("Ks") == 0)
-		{
-			float ks1, ks2, ks3;
-			iss >> readValue >> ks1 >> ks2 >> ks3;
-			ks.push_back(ks1);
-			ks.push_back(ks2);
-			ks.push_back(ks3);
-		}
-		else if (line.find("Ns") == 0)
-		{
-			iss >> readValue >> ns;
-		}
+		glm::vec3 position = area.min + (area.max - area.min) * glm::vec3(random(), random(), random());
+		glm::vec3 color = glm::vec3(random(), random(), random());
+		lights.push_back(PointLight{ glm::vec4(position, radius), glm::vec4(color * 2.0f, 1.0f) });
 	}
-	mtlFile.close();
+	return lights;
 }
 
-int loadTexture(string path)
+// Benchmark do JobSystem: custo de enviar e esperar jobs vazios, um parallelFor com
+// trabalho de verdade contra o mesmo lao em uma thread, e etapas encadeadas por
+// dependncias. No fim, a ocupao de cada thread durante o benchmark.
+void runJobBenchmark()
 {
-	GLuint texID;
-
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-
-	if (data)
-	{
-		if (nrChannels == 3)
+	cout << "JobSystem: " << jobSystem.getThreadCount() << " threads" << endl;
+	jobSystem.endFrame();
+
+	const int EMPTY_JOBS = 100000;
+	double start = glfwGetTime();
+	JobCounter empty;
+	for (int j = 0; j < EMPTY_JOBS; j++)
+		jobSystem.run([]() {}, &empty);
+	jobSystem.wait(empty);
+	double elapsed = glfwGetTime() - start;
+	cout << "Jobs vazios: " << EMPTY_JOBS << " em " << elapsed * 1000.0 << " ms (" << elapsed * 1e9 / EMPTY_JOBS << " ns por job)" << endl;
+
+	//Matrizes model de uma grade grande, em uma thread e divididas entre os jobs
+	const int OBJECTS = 1 << 20;
+	vector<glm::mat4> models(OBJECTS);
+	auto compose = [&](int begin, int end)
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		}
-		else
+			for (int k = begin; k < end; k++)
+			{
+				glm::mat4 model = glm::translate(glm::mat4(1), glm::vec3(k % 1024, k / 1024, 0.0f));
+				models[k] = glm::scale(glm::rotate(model, k * 0.001f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(0.5f));
+			}
+		};
+	start = glfwGetTime();
+	compose(0, OBJECTS);
+	double serial = glfwGetTime() - start;
+	start = glfwGetTime();
+	jobSystem.parallelFor(OBJECTS, 4096, compose);
+	double parallel = glfwGetTime() - start;
+	cout << "parallelFor (" << OBJECTS << " matrizes): " << serial * 1000.0 << " ms em uma thread, " << parallel * 1000.0 << " ms em jobs ("
+		<< serial / max(parallel, 1e-9) << "x)" << endl;
+
+	//Cada etapa s comea quando a anterior termina inteira. O grafo  montado dentro de um job:
+	//assim a primeira etapa s entra nas filas depois que todas as dependncias foram registradas
+	const int STAGES = 8, JOBS_PER_STAGE = 64;
+	JobCounter built, stages[STAGES];
+	atomic<int> finished(0);
+	atomic<bool> ordered(true);
+	start = glfwGetTime();
+	jobSystem.run([&]()
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
+			for (int s = 0; s < STAGES; s++)
+				for (int j = 0; j < JOBS_PER_STAGE; j++)
+				{
+					auto job = [&, s]()
+						{
+							if (finished.load() < s * JOBS_PER_STAGE)
+								ordered = false;
+							finished++;
+						};
+					jobSystem.runAfter(s == 0 ? built : stages[s - 1], job, &stages[s]);
+				}
+		}, &built);
+	jobSystem.wait(built);
+	jobSystem.wait(stages[STAGES - 1]);
+	elapsed = glfwGetTime() - start;
+	cout << "Dependencias: " << STAGES << " etapas de " << JOBS_PER_STAGE << " jobs em " << elapsed * 1000.0 << " ms, ordem "
+		<< (ordered ? "respeitada" : "VIOLADA") << endl;
+
+	jobSystem.endFrame();
+	for (size_t t = 0; t < jobSystem.lastFrame().size(); t++)
 	{
-		cout << "Failed to load texture" << endl;
+		const JobWorkerStats& worker = jobSystem.lastFrame()[t];
+		cout << "Thread " << (t == 0 ? string("principal") : to_string(t)) << ": " << worker.jobs << " jobs, " << worker.steals << " roubados, ocupada "
+			<< worker.utilization * 100.0f << "%" << endl;
 	}
-	stbi_image_free(data);
-	glBindTexture(GL_TEXTURE_2D, 0);
-	return texID;
 }
 
-std::vector<glm::vec3> generateControlPointsSet(const std::string& input) {
-	std::vector<glm::vec3> controlPoints;
-	std::istringstream iss(input);
-	float x, y, z;
-
-	while (iss >> x >> y >> z) {
-		controlPoints.push_back(glm::vec3(x, y, z));
+// Benchmark das matrizes model: o caminho do Mesh (translate * rotate * scale com ngulo
+// e eixo, um objeto por vez) contra o TransformBatch (quatrnios em SoA, 8 objetos por
+// iterao), cada um em uma thread e dividido entre os jobs. Mesmas transformaes nos dois.
+void runTransformBenchmark()
+{
+	const int OBJECTS = 1 << 20, REPEAT = 10;
+	srand(1);
+	auto random = []() { return (float)rand() / RAND_MAX; };
+	vector<glm::vec3> objectPositions(OBJECTS), axes(OBJECTS), scales(OBJECTS);
+	vector<float> angles(OBJECTS);
+	TransformBatch batch;
+	for (int k = 0; k < OBJECTS; k++)
+	{
+		objectPositions[k] = glm::vec3(random(), random(), random()) * 100.0f;
+		axes[k] = glm::normalize(glm::vec3(random(), random(), random()) + glm::vec3(0.01f));
+		angles[k] = random() * 360.0f;
+		scales[k] = glm::vec3(0.5f + random());
+		batch.add(objectPositions[k], glm::angleAxis(glm::radians(angles[k]), axes[k]), scales[k]);
 	}
 
-	return controlPoints;
-}
\ No newline at end of file
+	vector<glm::mat4> models(OBJECTS);
+	auto compose = [&](int begin, int end)
+		{
+			for (int k = begin; k < end; k++)
+			{
+				glm::mat4 model = glm::translate(glm::mat4(1), objectPositions[k]);
+				model = glm::rotate(model, glm::radians(angles[k]), axes[k]);
+				models[k] = glm::scale(model, scales[k]);
+			}
+		};
+	//Mdia de REPEAT execues, em ms
+	auto measure = [&](const function<void()>& run)
+		{
+			double start = glfwGetTime();
+			for (int r = 0; r < REPEAT; r++)
+				run();
+			return (glfwGetTime() - start) * 1000.0 / REPEAT;
+		};
+
+	double serial = measure([&]() { compose(0, OBJECTS); });
+	double parallel = measure([&]() { jobSystem.parallelFor(OBJECTS, 4096, compose); });
+	double batchSerial = measure([&]() { batch.compose(false); });
+	double batchParallel = measure([&]() { batch.compose(); });
+
+	float maxError = 0.0f;
+	for (int k = 0; k < OBJECTS; k++)
+		for (int c = 0; c < 4; c++)
+			maxError = max(maxError, glm::length(batch.getMatrices()[k][c] - models[k][c]));
+
+	cout << "Matrizes model (" << OBJECTS << " objetos, " << jobSystem.getThreadCount() << " threads):" << endl;
+	cout << "Mesh (glm): " << serial << " ms em uma thread, " << parallel << " ms em jobs" << endl;
+	cout << "TransformBatch: " << batchSerial << " ms em uma thread (" << serial / max(batchSerial, 1e-9) << "x), " << batchParallel
+		<< " ms em jobs (" << serial / max(batchParallel, 1e-9) << "x)" << endl;
+	cout << "Maior diferenca entre os dois: " << maxError << endl;
+}
@@ -0,0 +1,101 @@
+#include "PipelineStatistics.h"
+
+#include <cstring>
+#include <iostream>
+
+static bool hasPipelineStatistics()
+{
+	GLint major = 0, minor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	if (major > 4 || (major == 4 && minor >= 6))
+		return true;
+
+	GLint count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (GLint e = 0; e < count; e++)
+	{
+		const char* name = (const char*)glGetStringi(GL_EXTENSIONS, e);
+		if (name && strcmp(name, "GL_ARB_pipeline_statistics_query") == 0)
+			return true;
+	}
+	return false;
+}
+
+void PipelineStatistics::initialize(int nFrames)
+{
+	destroy();
+	this->nFrames = nFrames < 2 ? 2 : (nFrames > MAX_FRAMES ? MAX_FRAMES : nFrames);
+	frame = 0;
+	active = -1;
+	previous = PipelineStats{ 0, 0, 0 };
+	memset(issued, 0, sizeof(issued));
+
+	supported = hasPipelineStatistics();
+	if (!supported)
+	{
+		std::cout << "GL_ARB_pipeline_statistics_query indisponivel: sem contagem de fragmentos" << std::endl;
+		return;
+	}
+	for (int f = 0; f < this->nFrames; f++)
+		glCreateQueries(GL_FRAGMENT_SHADER_INVOCATIONS, PASS_COUNT, queries[f]);
+}
+
+void PipelineStatistics::destroy()
+{
+	if (!supported)
+		return;
+	for (int f = 0; f < nFrames; f++)
+		glDeleteQueries(PASS_COUNT, queries[f]);
+	supported = false;
+}
+
+void PipelineStatistics::begin(RenderPass pass)
+{
+	if (!supported || active >= 0)
+		return;
+	active = (int)pass;
+	glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS, queries[frame][active]);
+	issued[frame][active] = true;
+}
+
+void PipelineStatistics::end()
+{
+	if (!supported || active < 0)
+		return;
+	glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS);
+	active = -1;
+}
+
+void PipelineStatistics::endFrame()
+{
+	if (!supported)
+		return;
+	frame = (frame + 1) % nFrames;
+
+	//O quadro que volta a ser usado foi enviado h nFrames - 1 quadros
+	PipelineStats stats = { 0, 0, 0 };
+	bool complete = true;
+	GLuint64 counts[PASS_COUNT] = {};
+	for (int p = 0; p < PASS_COUNT; p++)
+	{
+		if (!issued[frame][p])
+			continue;
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(queries[frame][p], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+			glGetQueryObjectui64v(queries[frame][p], GL_QUERY_RESULT, &counts[p]);
+		else
+			complete = false;
+		issued[frame][p] = false;
+	}
+	if (!complete)
+	{
+		previous.pending++;
+		return;
+	}
+	stats.prepassFragments = counts[(int)RenderPass::DepthPrepass];
+	stats.shadingFragments = counts[(int)RenderPass::Shading];
+	stats.pending = previous.pending;
+	previous = stats;
+}
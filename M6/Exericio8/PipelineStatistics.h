@@ -0,0 +1,57 @@
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+// Passadas medidas separadamente no quadro
+enum class RenderPass
+{
+	DepthPrepass,
+	Shading,
+	Count
+};
+
+struct PipelineStats
+{
+	GLuint64 prepassFragments; //Invocaes do fragment shader na pr-passagem de profundidade
+	GLuint64 shadingFragments; //Invocaes do fragment shader na passagem de iluminao
+	unsigned int pending;      //Quadros descartados porque o resultado no tinha chegado da GPU (total)
+};
+
+// Conta as invocaes do fragment shader de cada passada com consultas
+// GL_FRAGMENT_SHADER_INVOCATIONS (ARB_pipeline_statistics_query, ncleo na 4.6).
+// As consultas giram em um anel de alguns quadros e o resultado s  lido
+// quando j est disponvel, ento a CPU nunca espera pela GPU; lastFrame()
+// mostra o quadro mais recente cujo resultado chegou.
+class PipelineStatistics
+{
+public:
+	static const int MAX_FRAMES = 4;
+	static const int PASS_COUNT = (int)RenderPass::Count;
+
+	PipelineStatistics() : frame(0), nFrames(0), supported(false), active(-1), previous{ 0, 0, 0 } {}
+
+	//Sem a extenso as chamadas viram no-ops e isSupported() retorna false
+	void initialize(int nFrames = 3);
+	void destroy();
+
+	//Uma consulta por vez: begin(DepthPrepass) ... end() begin(Shading) ... end()
+	void begin(RenderPass pass);
+	void end();
+	//Passa para o prximo quadro do anel e l o que j ficou pronto
+	void endFrame();
+
+	bool isSupported() const { return supported; }
+	const PipelineStats& lastFrame() const { return previous; }
+
+protected:
+	GLuint queries[MAX_FRAMES][PASS_COUNT];
+	bool issued[MAX_FRAMES][PASS_COUNT];
+	int frame;
+	int nFrames;
+	bool supported;
+	int active;
+	PipelineStats previous;
+};
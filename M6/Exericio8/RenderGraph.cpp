@@ -0,0 +1,474 @@
+#include "RenderGraph.h"
+#include "GLResources.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+// Barreira que torna visvel a quem usa o recurso com access o que um shader
+// escreveu antes por imagem ou SSBO (escritas em framebuffer j so coerentes)
+static GLbitfield barrierFor(GraphAccess access)
+{
+	switch (access)
+	{
+	case GraphAccess::Framebuffer: return GL_FRAMEBUFFER_BARRIER_BIT;
+	case GraphAccess::Sampled: return GL_TEXTURE_FETCH_BARRIER_BIT;
+	case GraphAccess::Image: return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+	case GraphAccess::Storage: return GL_SHADER_STORAGE_BARRIER_BIT;
+	case GraphAccess::Indirect: return GL_COMMAND_BARRIER_BIT;
+	case GraphAccess::VertexAttribute: return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+	case GraphAccess::Transfer: return GL_BUFFER_UPDATE_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT;
+	}
+	return 0;
+}
+
+static bool incoherentWrite(GraphAccess access)
+{
+	return access == GraphAccess::Image || access == GraphAccess::Storage;
+}
+
+static bool isDepthFormat(GLenum format)
+{
+	return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8 || format == GL_DEPTH_COMPONENT24
+		|| format == GL_DEPTH_COMPONENT32F || format == GL_DEPTH_COMPONENT16;
+}
+
+static bool sameDesc(const GraphTextureDesc& a, const GraphTextureDesc& b)
+{
+	return a.width == b.width && a.height == b.height && a.format == b.format && a.levels == b.levels;
+}
+
+GraphHandle RenderGraph::PassBuilder::createTexture(const char* name, const GraphTextureDesc& desc)
+{
+	Resource resource = { name, true, false, false, desc, 0, 0, -1, -1, -1, -1 };
+	if (resource.desc.levels < 1)
+		resource.desc.levels = 1;
+	return graph.addResource(resource, pass, GraphAccess::Framebuffer);
+}
+
+GraphHandle RenderGraph::PassBuilder::createBuffer(const char* name, GLsizeiptr size)
+{
+	Resource resource = { name, false, false, false, GraphTextureDesc{ 0, 0, 0, 0 }, size, 0, -1, -1, -1, -1 };
+	return graph.addResource(resource, pass, GraphAccess::Storage);
+}
+
+GraphHandle RenderGraph::PassBuilder::read(GraphHandle resource, GraphAccess access)
+{
+	if (!graph.validHandle(resource))
+		return -1;
+	graph.passes[pass].reads.push_back(Use{ resource, access });
+	return resource;
+}
+
+GraphHandle RenderGraph::PassBuilder::write(GraphHandle resource, GraphAccess access)
+{
+	if (!graph.validHandle(resource))
+		return -1;
+	int r = graph.versions[resource].resource;
+	if (graph.resources[r].latest != resource)
+		std::cout << "ERROR::RENDER_GRAPH::WRITE_TO_OLD_VERSION " << graph.resources[r].name << std::endl;
+	GraphHandle version = (GraphHandle)graph.versions.size();
+	graph.versions.push_back(Version{ r, resource, pass, access });
+	graph.resources[r].latest = version;
+	graph.passes[pass].writes.push_back(Use{ version, access });
+	return version;
+}
+
+void RenderGraph::PassBuilder::sideEffect()
+{
+	graph.passes[pass].sideEffect = true;
+}
+
+void RenderGraph::reset()
+{
+	passes.clear();
+	resources.clear();
+	versions.clear();
+	order.clear();
+	compiled = false;
+}
+
+void RenderGraph::destroy()
+{
+	reset();
+	for (PhysicalTexture& texture : texturePool)
+	{
+		if (texture.framebuffer)
+			glDeleteFramebuffers(1, &texture.framebuffer);
+		destroyTexture(texture.id);
+	}
+	for (PhysicalBuffer& buffer : bufferPool)
+		glDeleteBuffers(1, &buffer.id);
+	texturePool.clear();
+	bufferPool.clear();
+}
+
+GraphHandle RenderGraph::addResource(const Resource& resource, int writer, GraphAccess access)
+{
+	int r = (int)resources.size();
+	resources.push_back(resource);
+	GraphHandle version = (GraphHandle)versions.size();
+	versions.push_back(Version{ r, -1, writer, access });
+	resources[r].latest = version;
+	if (writer >= 0)
+		passes[writer].writes.push_back(Use{ version, access });
+	return version;
+}
+
+bool RenderGraph::validHandle(GraphHandle handle) const
+{
+	if (handle >= 0 && handle < (GraphHandle)versions.size())
+		return true;
+	std::cout << "ERROR::RENDER_GRAPH::INVALID_HANDLE " << handle << std::endl;
+	return false;
+}
+
+GraphHandle RenderGraph::importTexture(const char* name, GLuint texture)
+{
+	Resource resource = { name, true, true, false, GraphTextureDesc{ 0, 0, 0, 0 }, 0, texture, -1, -1, -1, -1 };
+	return addResource(resource, -1, GraphAccess::Framebuffer);
+}
+
+GraphHandle RenderGraph::importBuffer(const char* name, GLuint buffer)
+{
+	Resource resource = { name, false, true, false, GraphTextureDesc{ 0, 0, 0, 0 }, 0, buffer, -1, -1, -1, -1 };
+	return addResource(resource, -1, GraphAccess::Storage);
+}
+
+void RenderGraph::markOutput(GraphHandle resource)
+{
+	if (validHandle(resource))
+		resources[versions[resource].resource].output = true;
+}
+
+void RenderGraph::addPass(const char* name, const Setup& setup, const Execute& execute)
+{
+	int pass = (int)passes.size();
+	passes.push_back(Pass{ name, execute, {}, {}, false, false, 0 });
+	PassBuilder builder(*this, pass);
+	setup(builder);
+}
+
+void RenderGraph::compile()
+{
+	frame++;
+	current = RenderGraphStats{};
+	cull();
+	sortPasses();
+	computeBarriers();
+	releaseUnused();
+	allocateTransients();
+	compiled = true;
+}
+
+void RenderGraph::cull()
+{
+	//Parte das sadas e dos efeitos colaterais e sobe pelas verses lidas
+	std::vector<int> stack;
+	auto need = [&](int pass)
+		{
+			if (pass >= 0 && !passes[pass].needed)
+			{
+				passes[pass].needed = true;
+				stack.push_back(pass);
+			}
+		};
+	for (Pass& pass : passes)
+		pass.needed = false;
+	for (size_t p = 0; p < passes.size(); p++)
+		if (passes[p].sideEffect)
+			need((int)p);
+	for (const Resource& resource : resources)
+		if (resource.output)
+			need(versions[resource.latest].writer);
+
+	while (!stack.empty())
+	{
+		int pass = stack.back();
+		stack.pop_back();
+		for (const Use& use : passes[pass].reads)
+			need(versions[use.version].writer);
+	}
+
+	for (const Pass& pass : passes)
+		if (!pass.needed)
+			current.culled++;
+}
+
+void RenderGraph::sortPasses()
+{
+	//Arestas entre os passos mantidos: quem escreve a verso lida (RAW), quem escreveu
+	//a verso anterior (WAW) e quem leu a verso anterior (WAR) vm antes de quem escreve
+	size_t n = passes.size();
+	std::vector<std::vector<int>> successors(n);
+	std::vector<int> inDegree(n, 0);
+	auto edge = [&](int from, int to)
+		{
+			if (from < 0 || from == to || !passes[from].needed || !passes[to].needed)
+				return;
+			successors[from].push_back(to);
+			inDegree[to]++;
+		};
+
+	std::vector<std::vector<int>> readers(versions.size());
+	for (size_t p = 0; p < n; p++)
+		for (const Use& use : passes[p].reads)
+			readers[use.version].push_back((int)p);
+
+	for (size_t p = 0; p < n; p++)
+	{
+		for (const Use& use : passes[p].reads)
+			edge(versions[use.version].writer, (int)p);
+		for (const Use& use : passes[p].writes)
+		{
+			int previousVersion = versions[use.version].previous;
+			if (previousVersion < 0)
+				continue;
+			edge(versions[previousVersion].writer, (int)p);
+			for (int reader : readers[previousVersion])
+				edge(reader, (int)p);
+		}
+	}
+
+	//Kahn; entre passos prontos ao mesmo tempo, vale a ordem de declarao
+	std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+	for (size_t p = 0; p < n; p++)
+		if (passes[p].needed && inDegree[p] == 0)
+			ready.push((int)p);
+	order.clear();
+	while (!ready.empty())
+	{
+		int pass = ready.top();
+		ready.pop();
+		order.push_back(pass);
+		for (int next : successors[pass])
+			if (--inDegree[next] == 0)
+				ready.push(next);
+	}
+
+	size_t expected = n - current.culled;
+	if (order.size() != expected)
+	{
+		std::cout << "ERROR::RENDER_GRAPH::CYCLE - passos restantes na ordem de declaracao" << std::endl;
+		std::vector<bool> placed(n, false);
+		for (int pass : order)
+			placed[pass] = true;
+		for (size_t p = 0; p < n; p++)
+			if (passes[p].needed && !placed[p])
+				order.push_back((int)p);
+	}
+}
+
+void RenderGraph::computeBarriers()
+{
+	for (int pass : order)
+	{
+		Pass& p = passes[pass];
+		p.barriers = 0;
+		for (const Use& use : p.reads)
+		{
+			const Version& version = versions[use.version];
+			if (version.writer >= 0 && incoherentWrite(version.writeAccess))
+				p.barriers |= barrierFor(use.access);
+		}
+		for (const Use& use : p.writes)
+		{
+			int previousVersion = versions[use.version].previous;
+			if (previousVersion >= 0 && versions[previousVersion].writer >= 0 && incoherentWrite(versions[previousVersion].writeAccess))
+				p.barriers |= barrierFor(use.access);
+		}
+	}
+}
+
+void RenderGraph::releaseUnused()
+{
+	//Recursos do pool que nem o quadro anterior usou so liberados
+	for (size_t t = 0; t < texturePool.size();)
+	{
+		if (texturePool[t].lastFrame >= frame - 1)
+		{
+			t++;
+			continue;
+		}
+		if (texturePool[t].framebuffer)
+			glDeleteFramebuffers(1, &texturePool[t].framebuffer);
+		destroyTexture(texturePool[t].id);
+		texturePool.erase(texturePool.begin() + t);
+	}
+	for (size_t b = 0; b < bufferPool.size();)
+	{
+		if (bufferPool[b].lastFrame >= frame - 1)
+		{
+			b++;
+			continue;
+		}
+		glDeleteBuffers(1, &bufferPool[b].id);
+		bufferPool.erase(bufferPool.begin() + b);
+	}
+}
+
+void RenderGraph::allocateTransients()
+{
+	//Vida de cada transiente: do primeiro ao ltimo passo executado que toca alguma verso
+	for (size_t position = 0; position < order.size(); position++)
+	{
+		const Pass& pass = passes[order[position]];
+		auto touch = [&](const Use& use)
+			{
+				Resource& resource = resources[versions[use.version].resource];
+				if (resource.firstUse < 0)
+					resource.firstUse = (int)position;
+				resource.lastUse = (int)position;
+			};
+		for (const Use& use : pass.reads)
+			touch(use);
+		for (const Use& use : pass.writes)
+			touch(use);
+	}
+
+	std::vector<int> transients;
+	for (size_t r = 0; r < resources.size(); r++)
+		if (!resources[r].imported && resources[r].firstUse >= 0)
+			transients.push_back((int)r);
+	std::sort(transients.begin(), transients.end(), [this](int a, int b) { return resources[a].firstUse < resources[b].firstUse; });
+
+	//Primeiro encaixe: um recurso fsico livre (no usado no quadro ou j fora de vida) e compatvel
+	for (int r : transients)
+	{
+		Resource& resource = resources[r];
+		current.transientResources++;
+		if (resource.texture)
+		{
+			current.transientBytes += textureBytes(resource.desc);
+			int found = -1;
+			for (size_t t = 0; t < texturePool.size() && found < 0; t++)
+			{
+				const PhysicalTexture& texture = texturePool[t];
+				if (sameDesc(texture.desc, resource.desc) && (texture.lastFrame != frame || texture.freeAfter < resource.firstUse))
+					found = (int)t;
+			}
+			if (found < 0)
+			{
+				PhysicalTexture texture = { resource.desc, 0, 0, -1, frame - 1 };
+				glCreateTextures(GL_TEXTURE_2D, 1, &texture.id);
+				glTextureStorage2D(texture.id, resource.desc.levels, resource.desc.format, resource.desc.width, resource.desc.height);
+				glTextureParameteri(texture.id, GL_TEXTURE_MIN_FILTER, resource.desc.levels > 1 ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST);
+				glTextureParameteri(texture.id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTextureParameteri(texture.id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTextureParameteri(texture.id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+				found = (int)texturePool.size();
+				texturePool.push_back(texture);
+			}
+			PhysicalTexture& texture = texturePool[found];
+			if (texture.lastFrame != frame)
+			{
+				current.physicalResources++;
+				current.peakTransientBytes += textureBytes(texture.desc);
+			}
+			texture.lastFrame = frame;
+			texture.freeAfter = resource.lastUse;
+			resource.physical = found;
+			resource.id = texture.id;
+		}
+		else
+		{
+			current.transientBytes += resource.size;
+			int found = -1;
+			for (size_t b = 0; b < bufferPool.size() && found < 0; b++)
+			{
+				const PhysicalBuffer& buffer = bufferPool[b];
+				if (buffer.size >= resource.size && (buffer.lastFrame != frame || buffer.freeAfter < resource.firstUse))
+					found = (int)b;
+			}
+			if (found < 0)
+			{
+				PhysicalBuffer buffer = { resource.size, 0, -1, frame - 1 };
+				glCreateBuffers(1, &buffer.id);
+				glNamedBufferStorage(buffer.id, resource.size, nullptr, 0);
+				found = (int)bufferPool.size();
+				bufferPool.push_back(buffer);
+			}
+			PhysicalBuffer& buffer = bufferPool[found];
+			if (buffer.lastFrame != frame)
+			{
+				current.physicalResources++;
+				current.peakTransientBytes += buffer.size;
+			}
+			buffer.lastFrame = frame;
+			buffer.freeAfter = resource.lastUse;
+			resource.physical = found;
+			resource.id = buffer.id;
+		}
+	}
+}
+
+void RenderGraph::execute()
+{
+	if (!compiled)
+		compile();
+	for (int pass : order)
+	{
+		if (passes[pass].barriers)
+		{
+			glMemoryBarrier(passes[pass].barriers);
+			current.barriers++;
+		}
+		passes[pass].execute(*this);
+		current.passes++;
+	}
+	previous = current;
+}
+
+GLuint RenderGraph::getTexture(GraphHandle resource) const
+{
+	return validHandle(resource) ? resources[versions[resource].resource].id : 0;
+}
+
+GLuint RenderGraph::getBuffer(GraphHandle resource) const
+{
+	return validHandle(resource) ? resources[versions[resource].resource].id : 0;
+}
+
+GLuint RenderGraph::getFramebuffer(GraphHandle resource)
+{
+	if (!validHandle(resource))
+		return 0;
+	const Resource& r = resources[versions[resource].resource];
+	if (r.imported || !r.texture || r.physical < 0)
+		return 0;
+
+	PhysicalTexture& texture = texturePool[r.physical];
+	if (texture.framebuffer == 0)
+	{
+		glCreateFramebuffers(1, &texture.framebuffer);
+		GLenum attachment = GL_COLOR_ATTACHMENT0;
+		if (texture.desc.format == GL_DEPTH24_STENCIL8 || texture.desc.format == GL_DEPTH32F_STENCIL8)
+			attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+		else if (isDepthFormat(texture.desc.format))
+			attachment = GL_DEPTH_ATTACHMENT;
+		glNamedFramebufferTexture(texture.framebuffer, attachment, texture.id, 0);
+	}
+	return texture.framebuffer;
+}
+
+GLsizeiptr RenderGraph::textureBytes(const GraphTextureDesc& desc)
+{
+	GLsizeiptr texel = 4;
+	switch (desc.format)
+	{
+	case GL_R8: texel = 1; break;
+	case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: texel = 2; break;
+	case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8: texel = 8; break;
+	case GL_RGBA32F: texel = 16; break;
+	}
+	GLsizeiptr bytes = 0;
+	int width = desc.width, height = desc.height;
+	for (int level = 0; level < std::max(desc.levels, 1); level++)
+	{
+		bytes += (GLsizeiptr)width * height * texel;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return bytes;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+//GLAD
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+// Verso de um recurso do grafo (cada escrita cria uma verso nova); -1 = invlido
+typedef int GraphHandle;
+
+// Como um passo usa um recurso - define a barreira necessria entre passos
+enum class GraphAccess
+{
+	Framebuffer,     //alvo de desenho ou destino de blit
+	Sampled,         //texture()/texelFetch
+	Image,           //imageLoad/imageStore
+	Storage,         //SSBO
+	Indirect,        //GL_DRAW_INDIRECT_BUFFER
+	VertexAttribute, //buffer de vrtices/instncias
+	Transfer         //origem de blit, cpia ou leitura pela CPU
+};
+
+struct GraphTextureDesc
+{
+	int width, height;
+	GLenum format;
+	int levels;
+};
+
+struct RenderGraphStats
+{
+	unsigned int passes;             //Passos executados
+	unsigned int culled;             //Passos descartados (nada do que escrevem  usado)
+	unsigned int barriers;           //glMemoryBarrier inseridos
+	unsigned int transientResources; //Recursos transientes declarados pelos passos executados
+	unsigned int physicalResources;  //Texturas/buffers reais que os atenderam
+	GLsizeiptr transientBytes;       //Memria que os transientes usariam sem aliasing
+	GLsizeiptr peakTransientBytes;   //Memria real dos transientes no quadro
+};
+
+// Grafo de um quadro. Os passos declaram o que leem e escrevem; compile() ordena
+// os passos pelas dependncias (no pela ordem de declarao), descarta os que
+// no contribuem para nenhuma sada, calcula as barreiras entre quem escreve por
+// imagem/SSBO e quem l depois, e atende os recursos transientes com texturas e
+// buffers de um pool, reaproveitando os que j terminaram a vida no quadro.
+// O grafo  remontado a cada quadro (reset + addPass + compile + execute); s o
+// pool continua de um quadro para o outro.
+class RenderGraph
+{
+public:
+	class PassBuilder
+	{
+	public:
+		//Recursos que s existem durante o quadro (o passo que cria  o primeiro a escrever)
+		GraphHandle createTexture(const char* name, const GraphTextureDesc& desc);
+		GraphHandle createBuffer(const char* name, GLsizeiptr size);
+
+		GraphHandle read(GraphHandle resource, GraphAccess access);
+		//Retorna a verso nova; quem ler depois deste passo usa o handle retornado
+		GraphHandle write(GraphHandle resource, GraphAccess access);
+		//O passo tem efeito fora do grafo e nunca  descartado
+		void sideEffect();
+
+	private:
+		friend class RenderGraph;
+		PassBuilder(RenderGraph& graph, int pass) : graph(graph), pass(pass) {}
+		RenderGraph& graph;
+		int pass;
+	};
+
+	typedef std::function<void(PassBuilder&)> Setup;
+	typedef std::function<void(RenderGraph&)> Execute;
+
+	RenderGraph() : frame(0), compiled(false), current{}, previous{} {}
+
+	//Comea um quadro novo (esquece passos e recursos, mantm o pool)
+	void reset();
+	void destroy();
+
+	//Recursos que vivem fora do grafo; o contedo anterior ao quadro j est visvel
+	GraphHandle importTexture(const char* name, GLuint texture);
+	GraphHandle importBuffer(const char* name, GLuint buffer);
+	//A ltima verso do recurso  usada depois do quadro (janela, dado do prximo quadro)
+	void markOutput(GraphHandle resource);
+
+	//setup roda na hora; execute s em execute(), na ordem calculada
+	void addPass(const char* name, const Setup& setup, const Execute& execute);
+
+	void compile();
+	void execute();
+
+	//Nomes OpenGL dos recursos, vlidos dentro de execute
+	GLuint getTexture(GraphHandle resource) const;
+	GLuint getBuffer(GraphHandle resource) const;
+	//Framebuffer com a textura transiente anexada (profundidade ou cor 0); 0 para recursos importados
+	GLuint getFramebuffer(GraphHandle resource);
+
+	const RenderGraphStats& lastFrame() const { return previous; }
+
+protected:
+	struct Resource
+	{
+		std::string name;
+		bool texture;
+		bool imported;
+		bool output;
+		GraphTextureDesc desc;
+		GLsizeiptr size;
+		GLuint id;       //importado: o nome OpenGL; transiente: preenchido no compile
+		int physical;    //ndice no pool (transientes)
+		int latest;      //ltima verso
+		int firstUse, lastUse;
+	};
+
+	struct Version
+	{
+		int resource;
+		int previous;    //verso anterior do mesmo recurso (-1 na primeira)
+		int writer;      //passo que escreveu (-1 = contedo de fora do quadro)
+		GraphAccess writeAccess;
+	};
+
+	struct Use
+	{
+		GraphHandle version;
+		GraphAccess access;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		Execute execute;
+		std::vector<Use> reads, writes;
+		bool sideEffect;
+		bool needed;
+		GLbitfield barriers;
+	};
+
+	struct PhysicalTexture
+	{
+		GraphTextureDesc desc;
+		GLuint id, framebuffer;
+		int freeAfter;   //ltimo passo (posio na ordem) que usa a textura no quadro
+		int lastFrame;
+	};
+
+	struct PhysicalBuffer
+	{
+		GLsizeiptr size;
+		GLuint id;
+		int freeAfter;
+		int lastFrame;
+	};
+
+	GraphHandle addResource(const Resource& resource, int writer, GraphAccess access);
+	bool validHandle(GraphHandle handle) const;
+	void cull();
+	void sortPasses();
+	void computeBarriers();
+	void allocateTransients();
+	void releaseUnused();
+
+	static GLsizeiptr textureBytes(const GraphTextureDesc& desc);
+
+	std::vector<Pass> passes;
+	std::vector<Resource> resources;
+	std::vector<Version> versions;
+	std::vector<int> order; //ndices dos passos executados, na ordem de execuo
+
+	std::vector<PhysicalTexture> texturePool;
+	std::vector<PhysicalBuffer> bufferPool;
+	int frame;
+	bool compiled;
+
+	RenderGraphStats current;
+	RenderGraphStats previous;
+};
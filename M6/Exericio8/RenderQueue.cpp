@@ -0,0 +1,204 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+#include "StreamBuffer.h"
+#include "JobSystem.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstring>
+
+static const int PROGRAM_BITS = 8;
+static const int MATERIAL_BITS = 8;
+static const int TEXTURE_BITS = 12;
+static const int VERTEX_ARRAY_BITS = 11;
+static const int DEPTH_BITS = 24;
+static const int STATE_BITS = PROGRAM_BITS + MATERIAL_BITS + TEXTURE_BITS + VERTEX_ARRAY_BITS;
+
+static uint64_t maskBits(uint64_t value, int bits)
+{
+	return value & ((uint64_t(1) << bits) - 1);
+}
+
+void RenderQueue::setView(const glm::mat4& view, float nearPlane, float farPlane)
+{
+	this->view = view;
+	this->nearPlane = nearPlane;
+	this->farPlane = farPlane;
+}
+
+uint64_t RenderQueue::makeKey(RenderLayer layer, GLuint program, unsigned int material, GLuint texture, GLuint vertexArray, float depth)
+{
+	//Os nomes GL so pequenos e sequenciais; se passarem do campo s perdem o agrupamento, no a correo
+	uint64_t state = maskBits(program, PROGRAM_BITS);
+	state = (state << MATERIAL_BITS) | maskBits(material, MATERIAL_BITS);
+	state = (state << TEXTURE_BITS) | maskBits(texture, TEXTURE_BITS);
+	state = (state << VERTEX_ARRAY_BITS) | maskBits(vertexArray, VERTEX_ARRAY_BITS);
+
+	//depth em [0, 1] (0 = plano near)
+	uint64_t maxDepth = (uint64_t(1) << DEPTH_BITS) - 1;
+	uint64_t quantized = (uint64_t)(std::min(std::max(depth, 0.0f), 1.0f) * (float)maxDepth);
+
+	if (layer == RenderLayer::Opaque)
+		return (state << DEPTH_BITS) | quantized;
+	return (uint64_t(1) << 63) | ((maxDepth - quantized) << STATE_BITS) | state;
+}
+
+void RenderQueue::push(Mesh* mesh, RenderLayer layer, unsigned int material)
+{
+	glm::vec3 viewPos = glm::vec3(view * glm::vec4(mesh->getPosition(), 1.0f));
+	float depth = (-viewPos.z - nearPlane) / (farPlane - nearPlane);
+
+	entries.push_back(SortEntry{ makeKey(layer, mesh->getShader()->ID, material, mesh->getTextureID(), mesh->getVertexArray(), depth), (uint32_t)items.size() });
+	items.push_back(QueueItem{ mesh, layer, material });
+}
+
+void RenderQueue::radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+{
+	//LSD com dgitos de 8 bits; passadas em que todas as chaves tm o mesmo byte so puladas
+	scratch.resize(entries.size());
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = {};
+		for (const SortEntry& e : entries)
+			counts[(e.key >> shift) & 0xFF]++;
+		if (counts[(entries[0].key >> shift) & 0xFF] == entries.size())
+			continue;
+
+		size_t offset = 0;
+		for (int d = 0; d < 256; d++)
+		{
+			size_t c = counts[d];
+			counts[d] = offset;
+			offset += c;
+		}
+		for (const SortEntry& e : entries)
+			scratch[counts[(e.key >> shift) & 0xFF]++] = e;
+		entries.swap(scratch);
+	}
+}
+
+void RenderQueue::setRecordThreads(int threads)
+{
+	if (threads <= 0)
+		threads = std::max(1, jobSystem.getThreadCount());
+	recordThreads = threads;
+	lists.resize(threads);
+}
+
+void RenderQueue::prepare()
+{
+	current = RenderQueueStats{};
+	if (!items.empty())
+		radixSort(entries, scratch);
+
+	prepared.clear();
+	const QueueItem* last = nullptr;
+	size_t opaqueCount = 0;
+	for (const SortEntry& e : entries)
+	{
+		const QueueItem& item = items[e.item];
+		Mesh* mesh = item.mesh;
+
+		if (!last || last->mesh->getShader() != mesh->getShader())
+			current.programChanges++;
+		if (!last || last->material != item.material)
+			current.materialChanges++;
+		if (!last || last->mesh->getTextureID() != mesh->getTextureID())
+			current.textureChanges++;
+		if (!last || last->mesh->getVertexArray() != mesh->getVertexArray())
+			current.vertexArrayChanges++;
+		if (item.layer == RenderLayer::Opaque)
+			opaqueCount++;
+		prepared.push_back(item);
+		last = &item;
+	}
+	items.clear();
+	entries.clear();
+
+	//Um trecho do frameStream para todas as matrizes; sem espao, o quadro no desenha a fila
+	GLsizeiptr alignment = uniformBufferAlignment();
+	recorded = 0;
+	objectData = prepared.empty() ? StreamAllocation{} : frameStream.allocate((GLsizeiptr)prepared.size() * alignment, alignment);
+	if (!objectData.data)
+		prepared.clear();
+
+	//Os opacos vm primeiro na ordem das chaves
+	if (recordThreads > 1 && opaqueCount >= MIN_PARALLEL_ITEMS && !prepared.empty())
+		recordParallel(opaqueCount);
+	for (size_t k = recorded; k < prepared.size(); k++)
+		memcpy((unsigned char*)objectData.data + k * alignment, glm::value_ptr(prepared[k].mesh->getModelMatrix()), sizeof(glm::mat4));
+
+	current.draws = (unsigned int)prepared.size();
+	previous = current;
+}
+
+void RenderQueue::draw()
+{
+	double start = glfwGetTime();
+	for (size_t t = 0; t < lists.size() && recorded > 0; t++)
+		lists[t].replay();
+	previous.replayTime += glfwGetTime() - start;
+
+	GLsizeiptr alignment = uniformBufferAlignment();
+	bool blending = false;
+	for (size_t k = recorded; k < prepared.size(); k++)
+	{
+		const QueueItem& item = prepared[k];
+		Mesh* mesh = item.mesh;
+
+		//Transparentes: blending ligado e sem escrita de profundidade (a ordem de trs para a frente resolve)
+		if (item.layer == RenderLayer::Transparent && !blending)
+		{
+			glState.enable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glDepthMask(GL_FALSE);
+			blending = true;
+		}
+
+		mesh->getShader()->Use();
+		GLintptr offset = (GLintptr)k * alignment;
+		Mesh::bindObjectData(StreamAllocation{ (unsigned char*)objectData.data + offset, objectData.offset + offset, sizeof(glm::mat4) });
+		mesh->draw();
+	}
+	if (blending)
+	{
+		glState.disable(GL_BLEND);
+		glDepthMask(GL_TRUE);
+	}
+}
+
+void RenderQueue::recordParallel(size_t count)
+{
+	double start = glfwGetTime();
+	GLsizeiptr alignment = uniformBufferAlignment();
+	int threads = (int)std::min((size_t)recordThreads, count);
+	size_t perThread = (count + threads - 1) / threads;
+	JobCounter counter;
+	for (int t = 0; t < (int)lists.size(); t++)
+	{
+		lists[t].clear();
+		size_t begin = std::min(count, t * perThread);
+		size_t end = std::min(count, begin + perThread);
+		if (t >= threads || begin == end)
+			continue;
+		jobSystem.run([this, alignment, t, begin, end]()
+			{
+				CommandList& list = lists[t];
+				for (size_t k = begin; k < end; k++)
+				{
+					GLintptr offset = (GLintptr)k * alignment;
+					StreamAllocation slot = { (unsigned char*)objectData.data + offset, objectData.offset + offset, sizeof(glm::mat4) };
+					prepared[k].mesh->record(list, slot);
+				}
+			}, &counter);
+	}
+	jobSystem.wait(counter);
+	current.recordTime = glfwGetTime() - start;
+
+	//As listas so executadas na ordem dos trechos, a mesma da fila ordenada
+	for (const CommandList& list : lists)
+		current.recordedCommands += (unsigned int)list.size();
+	recorded = count;
+}
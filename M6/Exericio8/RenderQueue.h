@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Mesh.h"
+#include "CommandList.h"
+
+enum class RenderLayer
+{
+	Opaque = 0,
+	Transparent = 1
+};
+
+struct RenderQueueStats
+{
+	unsigned int draws;
+	unsigned int programChanges;
+	unsigned int materialChanges;
+	unsigned int textureChanges;
+	unsigned int vertexArrayChanges;
+	unsigned int recordedCommands; //Comandos gravados pelas threads (0 no caminho serial)
+	double recordTime;             //Gravao paralela (s)
+	double replayTime;             //Execuo das listas na thread da OpenGL, somando as passadas (s)
+};
+
+// Fila de desenho do quadro. Cada malha recebe uma chave de 64 bits:
+//   opaco:        [63] camada | [62-55] programa | [54-47] material | [46-35] textura | [34-24] VAO | [23-0] profundidade
+//   transparente: [63] camada | [62-39] profundidade invertida | [38-31] programa | [30-23] material | [22-11] textura | [10-0] VAO
+// Ordenando as chaves (radix sort), os opacos ficam agrupados por estado e, dentro
+// do mesmo estado, da frente para trs; os transparentes vm depois, de trs para a frente.
+// Com setRecordThreads(n > 1), os opacos j ordenados so divididos em n trechos
+// gravados em paralelo pelo JobSystem (matriz no frameStream + CommandList) e executados em ordem
+// na thread da OpenGL; os transparentes continuam no caminho serial.
+// prepare() ordena e escreve as matrizes (ou grava as listas) uma vez por quadro;
+// draw() s repete os desenhos, ento a pr-passagem de profundidade no escreve nada de novo.
+class RenderQueue
+{
+public:
+	RenderQueue() : view(1.0f), nearPlane(0.1f), farPlane(100.0f), recordThreads(1), objectData{}, recorded(0), previous{}, current{} {}
+
+	//Cmera do quadro, usada para a profundidade das chaves
+	void setView(const glm::mat4& view, float nearPlane, float farPlane);
+	//material: identificador escolhido pelo chamador (0 quando a cena tem um s material)
+	void push(Mesh* mesh, RenderLayer layer = RenderLayer::Opaque, unsigned int material = 0);
+	//Ordena, escreve a matriz de cada malha no frameStream e esvazia a fila
+	void prepare();
+	//Desenha o que o ltimo prepare() deixou pronto; pode ser chamado mais de uma vez no quadro
+	void draw();
+
+	//Trechos de gravao dos opacos (0 = um por thread do JobSystem); 1 desenha tudo na thread da OpenGL
+	void setRecordThreads(int threads);
+	int getRecordThreads() const { return recordThreads; }
+
+	const RenderQueueStats& lastFrame() const { return previous; }
+
+	static uint64_t makeKey(RenderLayer layer, GLuint program, unsigned int material, GLuint texture, GLuint vertexArray, float depth);
+
+protected:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t item;
+	};
+	struct QueueItem
+	{
+		Mesh* mesh;
+		RenderLayer layer;
+		unsigned int material;
+	};
+	static void radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+	//Grava prepared[0, count) (s opacos) nas listas, com as matrizes no bloco
+	void recordParallel(size_t count);
+
+	//Abaixo disso o custo de dividir em jobs passa do ganho
+	static const size_t MIN_PARALLEL_ITEMS = 256;
+
+	glm::mat4 view;
+	float nearPlane, farPlane;
+	std::vector<QueueItem> items;
+	std::vector<SortEntry> entries, scratch;
+	int recordThreads;
+	//Fila do quadro j ordenada e o trecho do frameStream com uma matriz por malha (alinhada para UBO)
+	std::vector<QueueItem> prepared;
+	StreamAllocation objectData;
+	size_t recorded;  //prepared[0, recorded) est nas listas
+	std::vector<CommandList> lists;
+	RenderQueueStats previous, current;
+};
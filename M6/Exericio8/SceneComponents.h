@@ -0,0 +1,55 @@
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "GeometryArena.h"
+#include "Shader.h"
+
+// Componentes das entidades da cena (EntityWorld). S dados; quem os atualiza
+// so as funes de SceneSystems.
+
+//Mesmos parmetros do Mesh; model  composta por Systems::composeTransforms
+struct TransformComponent
+{
+	glm::vec3 position;
+	float angle;        //graus, em torno de axis
+	glm::vec3 axis;
+	glm::vec3 scale;
+	glm::mat4 model;
+};
+
+//O que o DrawBatcher precisa para desenhar a entidade
+struct RenderableComponent
+{
+	Shader* shader;
+	GeometryArena* arena;
+	int allocation;
+	GLuint textureID;
+};
+
+//Anda pelos pontos de uma curva a cada passo fixo; a posio desenhada fica entre previous e current
+struct CurveFollowerComponent
+{
+	float point;        //ndice (fracionrio) do ponto atual na curva
+	float speed;        //Pontos por passo
+	glm::vec3 offset;   //Somado ao ponto da curva
+	glm::vec3 previous, current;
+};
+
+struct BoundsComponent
+{
+	BoundingSphere localSphere;
+	BoundingSphere worldSphere; //Atualizada por Systems::updateBounds
+};
+
+//Entidade visvel copiada para o envio do quadro
+struct EntityDraw
+{
+	RenderableComponent renderable;
+	glm::mat4 model;
+};
@@ -0,0 +1,109 @@
+#include "SceneGraph.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+//GLM
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+
+int SceneGraph::createNode(int parent, glm::vec3 position, glm::vec3 scale, float angle, glm::vec3 axis)
+{
+	int node = (int)nodes.size();
+	nodes.push_back(Node{ parent, NO_PARENT, NO_PARENT, position, scale, angle, axis, false });
+	local.push_back(glm::mat4(1));
+	world.push_back(glm::mat4(1));
+	if (parent != NO_PARENT)
+	{
+		nodes[node].nextSibling = nodes[parent].firstChild;
+		nodes[parent].firstChild = node;
+	}
+	markDirty(node);
+	return node;
+}
+
+void SceneGraph::clear()
+{
+	nodes.clear();
+	local.clear();
+	world.clear();
+	dirtyNodes.clear();
+	changed.clear();
+}
+
+void SceneGraph::setPosition(int node, glm::vec3 position)
+{
+	nodes[node].position = position;
+	markDirty(node);
+}
+
+void SceneGraph::setRotation(int node, float angle, glm::vec3 axis)
+{
+	nodes[node].angle = angle;
+	nodes[node].axis = axis;
+	markDirty(node);
+}
+
+void SceneGraph::setScale(int node, glm::vec3 scale)
+{
+	nodes[node].scale = scale;
+	markDirty(node);
+}
+
+void SceneGraph::markDirty(int node)
+{
+	if (nodes[node].dirty)
+		return;
+	nodes[node].dirty = true;
+	dirtyNodes.push_back(node);
+}
+
+void SceneGraph::update()
+{
+	double start = glfwGetTime();
+	SceneGraphStats stats = { (unsigned int)nodes.size(), 0, 0, 0.0 };
+	changed.clear();
+
+	//Pais antes dos filhos: um n marcado dentro de uma subrvore j recalculada
+	//chega aqui com dirty == false e  pulado
+	std::sort(dirtyNodes.begin(), dirtyNodes.end());
+	for (int node : dirtyNodes)
+	{
+		if (!nodes[node].dirty)
+			continue;
+		updateSubtree(node);
+		stats.dirtyRoots++;
+	}
+	dirtyNodes.clear();
+
+	stats.updated = (unsigned int)changed.size();
+	stats.time = glfwGetTime() - start;
+	previous = stats;
+}
+
+void SceneGraph::updateSubtree(int root)
+{
+	//Pilha explcita: hierarquias fundas no estouram a pilha de chamadas
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int node = stack.back();
+		stack.pop_back();
+
+		Node& n = nodes[node];
+		if (n.dirty)
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1), n.position);
+			model = glm::rotate(model, glm::radians(n.angle), n.axis);
+			local[node] = glm::scale(model, n.scale);
+			n.dirty = false;
+		}
+		world[node] = n.parent == NO_PARENT ? local[node] : world[n.parent] * local[node];
+		changed.push_back(node);
+
+		for (int child = n.firstChild; child != NO_PARENT; child = nodes[child].nextSibling)
+			stack.push_back(child);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+struct SceneGraphStats
+{
+	unsigned int nodes;
+	unsigned int dirtyRoots; //Ns marcados que no estavam dentro de outra subrvore marcada
+	unsigned int updated;    //Matrizes de mundo recalculadas
+	double time;             //segundos
+};
+
+// Hierarquia de transformaes. Cada n tem uma transformao local relativa ao pai
+// (posio, rotao e escala, como no Mesh) e uma matriz de mundo guardada entre os
+// quadros. Mudar a local s marca o n; update() recalcula a subrvore de cada n
+// marcado e nada mais, ento uma hierarquia parada no custa nada por quadro.
+// Os ns ficam em vetores e so referenciados por ndice; o pai sempre  criado antes
+// dos filhos, ento a ordem dos ndices j  uma ordem de pai antes de filho.
+class SceneGraph
+{
+public:
+	static const int NO_PARENT = -1;
+
+	SceneGraph() : previous{} {}
+
+	//Retorna o identificador do n; a matriz de mundo fica vlida no prximo update()
+	int createNode(int parent, glm::vec3 position = glm::vec3(0.0f), glm::vec3 scale = glm::vec3(1.0f), float angle = 0.0f, glm::vec3 axis = glm::vec3(0.0f, 0.0f, 1.0f));
+	void clear();
+
+	void setPosition(int node, glm::vec3 position);
+	void setRotation(int node, float angle, glm::vec3 axis);
+	void setScale(int node, glm::vec3 scale);
+	glm::vec3 getPosition(int node) const { return nodes[node].position; }
+	int getParent(int node) const { return nodes[node].parent; }
+
+	//Recalcula as subrvores marcadas desde o ltimo update()
+	void update();
+	//Vlida depois do update()
+	const glm::mat4& getWorldMatrix(int node) const { return world[node]; }
+	//Ns cuja matriz de mundo mudou no ltimo update() (para atualizar s o que depende deles)
+	const std::vector<int>& getChanged() const { return changed; }
+
+	int getNodeCount() const { return (int)nodes.size(); }
+	const SceneGraphStats& lastFrame() const { return previous; }
+
+protected:
+	struct Node
+	{
+		int parent;
+		int firstChild, nextSibling; //Lista dos filhos
+		glm::vec3 position;
+		glm::vec3 scale;
+		float angle;                 //graus
+		glm::vec3 axis;
+		bool dirty;                  //A local mudou desde o ltimo update()
+	};
+
+	void markDirty(int node);
+	void updateSubtree(int root);
+
+	std::vector<Node> nodes;
+	std::vector<glm::mat4> local, world;
+	std::vector<int> dirtyNodes;
+	std::vector<int> changed;
+	std::vector<int> stack;
+
+	SceneGraphStats previous;
+};
@@ -0,0 +1,84 @@
+#include "SceneSystems.h"
+
+#include <atomic>
+
+//GLM
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Systems
+{
+	void followCurves(EntityWorld& world, const std::vector<glm::vec3>& curve, int steps, float alpha)
+	{
+		if (curve.empty())
+			return;
+		float length = (float)curve.size();
+		world.parallelForEachChunk<CurveFollowerComponent, TransformComponent>(
+			[&](int count, Entity*, CurveFollowerComponent* followers, TransformComponent* transforms)
+			{
+				for (int e = 0; e < count; e++)
+				{
+					CurveFollowerComponent& follower = followers[e];
+					for (int step = 0; step < steps; step++)
+					{
+						follower.point += follower.speed;
+						//Na volta para o comeo da curva o objeto salta: no interpola entre as pontas
+						bool wrapped = follower.point >= length;
+						if (wrapped)
+							follower.point -= length;
+						follower.previous = wrapped ? curve[(int)follower.point] : follower.current;
+						follower.current = curve[(int)follower.point];
+					}
+					transforms[e].position = glm::mix(follower.previous, follower.current, alpha) + follower.offset;
+				}
+			});
+	}
+
+	void composeTransforms(EntityWorld& world)
+	{
+		world.parallelForEachChunk<TransformComponent>([](int count, Entity*, TransformComponent* transforms)
+			{
+				for (int e = 0; e < count; e++)
+				{
+					TransformComponent& transform = transforms[e];
+					glm::mat4 model = glm::translate(glm::mat4(1), transform.position);
+					model = glm::rotate(model, glm::radians(transform.angle), transform.axis);
+					transform.model = glm::scale(model, transform.scale);
+				}
+			});
+	}
+
+	void updateBounds(EntityWorld& world)
+	{
+		world.parallelForEachChunk<TransformComponent, BoundsComponent>([](int count, Entity*, TransformComponent* transforms, BoundsComponent* bounds)
+			{
+				for (int e = 0; e < count; e++)
+					bounds[e].worldSphere = transformSphere(bounds[e].localSphere, transforms[e].model);
+			});
+	}
+
+	void collectVisible(EntityWorld& world, const Frustum& frustum, std::vector<EntityDraw>& draws)
+	{
+		//Cada chunk testa as suas esferas e reserva de uma vez o trecho da sada para as visveis
+		draws.resize(world.getEntityCount());
+		std::atomic<int> written(0);
+		world.parallelForEachChunk<RenderableComponent, TransformComponent, BoundsComponent>(
+			[&](int count, Entity*, RenderableComponent* renderables, TransformComponent* transforms, BoundsComponent* bounds)
+			{
+				std::vector<int> visible;
+				visible.reserve(count);
+				for (int e = 0; e < count; e++)
+				{
+					const BoundingSphere& sphere = bounds[e].worldSphere;
+					bool inside = true;
+					for (const glm::vec4& plane : frustum.planes)
+						inside = inside && glm::dot(glm::vec3(plane), sphere.center) + plane.w >= -sphere.radius;
+					if (inside)
+						visible.push_back(e);
+				}
+				int first = written.fetch_add((int)visible.size());
+				for (size_t v = 0; v < visible.size(); v++)
+					draws[first + v] = EntityDraw{ renderables[visible[v]], transforms[visible[v]].model };
+			});
+		draws.resize(written.load());
+	}
+}
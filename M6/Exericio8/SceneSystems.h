@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "EntityWorld.h"
+#include "FrustumCuller.h"
+#include "SceneComponents.h"
+
+// Sistemas sobre as entidades. Cada um percorre s os arrays dos componentes
+// que usa, chunk por chunk, com os chunks divididos entre as threads do JobSystem.
+namespace Systems
+{
+	//steps passos fixos de cada CurveFollower, depois a posio do Transform entre os dois ltimos pontos (alpha)
+	void followCurves(EntityWorld& world, const std::vector<glm::vec3>& curve, int steps, float alpha);
+	//model = translate * rotate * scale de cada Transform
+	void composeTransforms(EntityWorld& world);
+	//Esfera de mundo de quem tem Transform e Bounds
+	void updateBounds(EntityWorld& world);
+	//Entidades desenhveis com a esfera dentro do frustum (a ordem entre chunks no  fixa)
+	void collectVisible(EntityWorld& world, const Frustum& frustum, std::vector<EntityDraw>& draws);
+}
@@ -14,12 +14,19 @@
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include "UniformReflection.h"
+#include "GLState.h"
+#include "GLExtensions.h"
+
 using namespace std;
 
 class Shader
 {
 public:
 	GLuint ID;
+	// Active uniforms and uniform blocks, read once after linking (sorted by name hash)
+	std::vector<UniformInfo> uniforms;
+	std::vector<UniformBlockInfo> uniformBlocks;
 	// Constructor generates the shader on the fly
 	Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
 	{
@@ -94,12 +101,55 @@ public:
 		// Delete the shaders as they're linked into our program now and no longer necessery
 		glDeleteShader(vertex);
 		glDeleteShader(fragment);
-
+		// Reflect the program interface so typed setters don't need glGetUniformLocation
+		reflectProgram(this->ID, uniforms, uniformBlocks);
+	}
+	// Compute shader program (only one stage)
+	explicit Shader(const GLchar* computePath)
+	{
+		std::string computeCode;
+		std::ifstream cShaderFile;
+		cShaderFile.exceptions(std::ifstream::badbit);
+		try
+		{
+			cShaderFile.open(computePath);
+			std::stringstream cShaderStream;
+			cShaderStream << cShaderFile.rdbuf();
+			cShaderFile.close();
+			computeCode = cShaderStream.str();
+		}
+		catch (std::ifstream::failure e)
+		{
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+		}
+		const GLchar* cShaderCode = computeCode.c_str();
+		GLint success;
+		GLchar infoLog[512];
+		GLuint compute = glCreateShader(GL_COMPUTE_SHADER);
+		glShaderSource(compute, 1, &cShaderCode, NULL);
+		glCompileShader(compute);
+		glGetShaderiv(compute, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(compute, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+		}
+		this->ID = glCreateProgram();
+		glAttachShader(this->ID, compute);
+		glLinkProgram(this->ID);
+		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(this->ID, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+		}
+		glDeleteShader(compute);
+		reflectProgram(this->ID, uniforms, uniformBlocks);
 	}
 	// Uses the current shader
 	void Use()
 	{
-		glUseProgram(this->ID);
+		glState.useProgram(this->ID);
 	}
 
 	void setBool(const std::string& name, bool value) const
@@ -131,5 +181,72 @@ public:
 	{
 		glUniformMatrix4fv(glGetUniformLocation(this->ID, name.c_str()), 1, GL_FALSE, v);
 	}
+	// ------------------------------------------------------------------------
+	// Checks the C++ declarations against the reflected interface and prints mismatches
+	template <int N>
+	bool validate(const char* label, const UniformSignature(&declared)[N]) const
+	{
+		return validateProgram(label, uniforms, uniformBlocks, declared, N);
+	}
+
+	template <int N, int M>
+	bool validate(const char* label, const UniformSignature(&declared)[N], const UniformBlockDecl(&declaredBlocks)[M]) const
+	{
+		return validateProgram(label, uniforms, uniformBlocks, declared, N, declaredBlocks, M);
+	}
+	// ------------------------------------------------------------------------
+	// Location of a declared uniform, -1 if it is not active (glUniform* ignores -1)
+	GLint location(const UniformSignature& decl) const
+	{
+		const UniformInfo* info = findUniform(uniforms, decl.hash);
+		return info ? info->location : -1;
+	}
+
+	GLint blockIndex(const UniformBlockDecl& decl) const
+	{
+		const UniformBlockInfo* info = findUniformBlock(uniformBlocks, decl.hash);
+		return info ? (GLint)info->index : -1;
+	}
+	// ------------------------------------------------------------------------
+	// Typed setters: no string construction and no name lookup in the driver
+	void set(const UniformDecl<bool>& u, bool value) const
+	{
+		glUniform1i(location(u), (int)value);
+	}
+
+	void set(const UniformDecl<int>& u, int value) const
+	{
+		glUniform1i(location(u), value);
+	}
+
+	void set(const UniformDecl<float>& u, float value) const
+	{
+		glUniform1f(location(u), value);
+	}
+
+	void set(const UniformDecl<glm::vec2>& u, const glm::vec2& value) const
+	{
+		glUniform2f(location(u), value.x, value.y);
+	}
+
+	void set(const UniformDecl<glm::vec3>& u, const glm::vec3& value) const
+	{
+		glUniform3f(location(u), value.x, value.y, value.z);
+	}
+
+	void set(const UniformDecl<glm::vec4>& u, const glm::vec4& value) const
+	{
+		glUniform4f(location(u), value.x, value.y, value.z, value.w);
+	}
+
+	void set(const UniformDecl<glm::ivec3>& u, const glm::ivec3& value) const
+	{
+		glUniform3i(location(u), value.x, value.y, value.z);
+	}
+
+	void set(const UniformDecl<glm::mat4>& u, const glm::mat4& value) const
+	{
+		glUniformMatrix4fv(location(u), 1, GL_FALSE, &value[0][0]);
+	}
 };
 
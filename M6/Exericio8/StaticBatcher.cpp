@@ -0,0 +1,109 @@
+#include "StaticBatcher.h"
+#include "GLState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+void StaticBatcher::add(const Mesh& mesh, const std::vector<MeshVertex>& vertices, const std::vector<GLuint>& indices)
+{
+	sources.push_back(Source{ &vertices, &indices, mesh.getModelMatrix(), mesh.getShader(), mesh.getTextureID(), mesh.getWorldSphere().center });
+}
+
+void StaticBatcher::build(float chunkSize)
+{
+	//Material primeiro na chave: os blocos ficam ordenados por estado para o desenho
+	typedef std::tuple<Shader*, GLuint, int, int, int> ChunkKey;
+	std::map<ChunkKey, std::vector<int>> groups;
+	size_t totalVertices = 0, totalIndices = 0;
+	for (size_t s = 0; s < sources.size(); s++)
+	{
+		const Source& source = sources[s];
+		glm::ivec3 cell = glm::ivec3(glm::floor(source.center / chunkSize));
+		groups[ChunkKey(source.shader, source.textureID, cell.x, cell.y, cell.z)].push_back((int)s);
+		totalVertices += source.vertices->size();
+		totalIndices += source.indices->size();
+	}
+
+	arena.destroy();
+	chunks.clear();
+	if (sources.empty())
+		return;
+	arena.initialize(sizeof(MeshVertex), (GLuint)totalVertices, (GLuint)totalIndices);
+	setupMeshVertexFormat(arena);
+
+	std::vector<MeshVertex> vertices;
+	std::vector<GLuint> indices;
+	for (const auto& group : groups)
+	{
+		vertices.clear();
+		indices.clear();
+		BoundingBox box{ glm::vec3(INFINITY), glm::vec3(-INFINITY) };
+
+		for (int s : group.second)
+		{
+			const Source& source = sources[s];
+			glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(source.model)));
+			GLuint base = (GLuint)vertices.size();
+			for (const MeshVertex& v : *source.vertices)
+			{
+				MeshVertex world = v;
+				world.position = glm::vec3(source.model * glm::vec4(v.position, 1.0f));
+				world.normal = glm::normalize(normalMatrix * v.normal);
+				box.min = glm::min(box.min, world.position);
+				box.max = glm::max(box.max, world.position);
+				vertices.push_back(world);
+			}
+			for (GLuint index : *source.indices)
+				indices.push_back(base + index);
+		}
+
+		Chunk chunk;
+		chunk.shader = std::get<0>(group.first);
+		chunk.textureID = std::get<1>(group.first);
+		chunk.allocation = arena.allocate(vertices.data(), vertices.size(), indices.data(), indices.size());
+		chunk.box = box;
+		chunks.push_back(chunk);
+	}
+
+	//A geometria de origem pertence ao chamador; s as cpias transformadas ficam
+	sources.clear();
+}
+
+void StaticBatcher::destroy()
+{
+	arena.destroy();
+	chunks.clear();
+	sources.clear();
+}
+
+void StaticBatcher::draw(const Frustum& frustum)
+{
+	if (chunks.empty())
+		return;
+	//Com a pr-passagem de profundidade draw  chamado duas vezes no quadro; vale a ltima
+	current = StaticBatchStats{};
+
+	//Vrtices j esto em coordenadas de mundo
+	Mesh::bindIdentityObjectData();
+	for (const Chunk& chunk : chunks)
+	{
+		current.chunks++;
+		if (frustum.test(chunk.box) == FrustumTest::Outside)
+		{
+			current.culled++;
+			continue;
+		}
+		chunk.shader->Use();
+		glState.bindTexture(0, GL_TEXTURE_2D, chunk.textureID);
+		arena.draw(chunk.allocation);
+		current.drawn++;
+	}
+}
+
+void StaticBatcher::endFrame()
+{
+	previous = current;
+	current = StaticBatchStats{};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+
+#include "Mesh.h"
+#include "GeometryArena.h"
+#include "FrustumCuller.h"
+
+struct StaticBatchStats
+{
+	unsigned int chunks;
+	unsigned int drawn;
+	unsigned int culled;
+};
+
+// Junta as malhas marcadas como estticas em poucos blocos de geometria j
+// transformada para o mundo. As malhas so agrupadas por material (shader +
+// textura) e por clula de uma grade de chunkSize unidades; cada grupo vira uma
+// alocao na arena prpria do batcher, com uma caixa para o culling. No quadro
+// no h matriz por objeto nem desenho por objeto: um desenho por bloco visvel.
+class StaticBatcher
+{
+public:
+	StaticBatcher() : previous{}, current{} {}
+
+	//vertices/indices: a mesma geometria que a malha usa na arena (precisa existir at build())
+	void add(const Mesh& mesh, const std::vector<MeshVertex>& vertices, const std::vector<GLuint>& indices);
+	void build(float chunkSize = 32.0f);
+	void destroy();
+
+	void draw(const Frustum& frustum);
+	void endFrame();
+
+	int getChunkCount() const { return (int)chunks.size(); }
+	const StaticBatchStats& lastFrame() const { return previous; }
+
+protected:
+	struct Source
+	{
+		const std::vector<MeshVertex>* vertices;
+		const std::vector<GLuint>* indices;
+		glm::mat4 model;
+		Shader* shader;
+		GLuint textureID;
+		glm::vec3 center;
+	};
+	struct Chunk
+	{
+		Shader* shader;
+		GLuint textureID;
+		int allocation;
+		BoundingBox box;
+	};
+
+	std::vector<Source> sources;
+	std::vector<Chunk> chunks;
+	GeometryArena arena;
+	StaticBatchStats previous, current;
+};
@@ -0,0 +1,115 @@
+#include "StreamBuffer.h"
+#include "GLState.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <iostream>
+
+StreamBuffer frameStream;
+
+void StreamBuffer::initialize(GLsizeiptr requestedSize, int nFrames)
+{
+	destroy();
+	//allocate() alinha o incio dentro da regio; com a regio mltipla do maior alinhamento,
+	//o deslocamento absoluto (frame * regionSize + incio) tambm fica alinhado
+	GLsizeiptr alignment = std::max(uniformBufferAlignment(), storageBufferAlignment());
+	regionSize = (requestedSize + alignment - 1) / alignment * alignment;
+	this->nFrames = nFrames < 1 ? 1 : (nFrames > MAX_FRAMES ? MAX_FRAMES : nFrames);
+	frame = 0;
+	head = 0;
+	for (int i = 0; i < MAX_FRAMES; i++)
+		fences[i] = 0;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &ID);
+	glNamedBufferStorage(ID, regionSize * this->nFrames, nullptr, flags);
+	mapped = (unsigned char*)glMapNamedBufferRange(ID, 0, regionSize * this->nFrames, flags);
+	if (!mapped)
+		std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+}
+
+void StreamBuffer::destroy()
+{
+	if (ID == 0)
+		return;
+	for (int i = 0; i < MAX_FRAMES; i++)
+	{
+		if (fences[i])
+			glDeleteSync(fences[i]);
+		fences[i] = 0;
+	}
+	glUnmapNamedBuffer(ID);
+	glDeleteBuffers(1, &ID);
+	glState.forgetBuffer(ID);
+	ID = 0;
+	mapped = nullptr;
+}
+
+void StreamBuffer::beginFrame()
+{
+	previous = current;
+	current = StreamStats{};
+
+	frame = (frame + 1) % nFrames;
+	head = 0;
+
+	GLsync fence = fences[frame];
+	if (!fence)
+		return;
+
+	//Sem flush na primeira tentativa: se a fence ainda no chegou na GPU, a segunda tentativa faz o flush
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		double start = glfwGetTime();
+		do
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); //1 ms
+		} while (result == GL_TIMEOUT_EXPIRED);
+		current.waits++;
+		totalWaits++;
+		current.waitTime += glfwGetTime() - start;
+	}
+	glDeleteSync(fence);
+	fences[frame] = 0;
+}
+
+void StreamBuffer::endFrame()
+{
+	if (fences[frame])
+		glDeleteSync(fences[frame]);
+	fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamAllocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+	GLsizeiptr start = (head + alignment - 1) / alignment * alignment;
+	if (!mapped || start + size > regionSize)
+	{
+		current.overflows++;
+		return StreamAllocation{ nullptr, 0, 0 };
+	}
+	head = start + size;
+	current.bytesUsed = head;
+
+	GLintptr offset = (GLintptr)frame * regionSize + start;
+	return StreamAllocation{ mapped + offset, offset, size };
+}
+
+GLsizeiptr uniformBufferAlignment()
+{
+	static GLint alignment = 0;
+	if (alignment == 0)
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return alignment > 0 ? alignment : 256;
+}
+
+GLsizeiptr storageBufferAlignment()
+{
+	static GLint alignment = 0;
+	if (alignment == 0)
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return alignment > 0 ? alignment : 256;
+}
@@ -0,0 +1,70 @@
+// Buffer de streaming: um nico buffer imutvel mapeado de forma persistente
+// (glBufferStorage + MAP_PERSISTENT/COHERENT), dividido em uma regio por
+// quadro em voo. A CPU escreve direto no ponteiro mapeado, sem glBufferData,
+// e uma fence por regio garante que a GPU j terminou de ler antes de reusar.
+
+#pragma once
+
+//GLAD
+#include <glad/glad.h>
+
+#include "GLExtensions.h"
+
+struct StreamAllocation
+{
+	void* data;       //Ponteiro mapeado para escrita (nullptr se a regio do quadro lotou)
+	GLintptr offset;  //Offset em bytes a partir do incio do buffer (para glBindBufferRange etc.)
+	GLsizeiptr size;
+};
+
+struct StreamStats
+{
+	unsigned int waits;         //Quadros em que a CPU precisou esperar a fence da regio
+	double waitTime;            //Tempo total esperando, em segundos
+	GLsizeiptr bytesUsed;       //Bytes alocados no quadro
+	unsigned int overflows;     //Alocaes recusadas por falta de espao na regio
+};
+
+class StreamBuffer
+{
+public:
+	static const int MAX_FRAMES = 4;
+
+	StreamBuffer() : ID(0), mapped(nullptr), regionSize(0), nFrames(0), frame(0), head(0), totalWaits(0), current{}, previous{} {}
+	//requestedSize bytes por quadro (arredondado para o alinhamento de UBO/SSBO), nFrames regies (3 = triple buffering)
+	void initialize(GLsizeiptr requestedSize, int nFrames = 3);
+	void destroy();
+
+	//Avana para a prxima regio, esperando a fence dela se a GPU ainda estiver usando
+	void beginFrame();
+	//Coloca a fence que protege a regio do quadro atual
+	void endFrame();
+
+	//Reserva size bytes alinhados na regio do quadro atual
+	StreamAllocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+	const StreamStats& lastFrame() const { return previous; }
+	//Total de esperas desde a criao
+	unsigned int getTotalWaits() const { return totalWaits; }
+
+	GLuint ID;
+
+protected:
+	unsigned char* mapped;
+	GLsizeiptr regionSize;
+	int nFrames;
+	int frame;
+	GLsizeiptr head;
+	GLsync fences[MAX_FRAMES];
+	unsigned int totalWaits;
+	StreamStats current;
+	StreamStats previous;
+};
+
+//Alinhamento exigido pelo driver para glBindBufferRange(GL_UNIFORM_BUFFER, ...)
+GLsizeiptr uniformBufferAlignment();
+//Idem para glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ...)
+GLsizeiptr storageBufferAlignment();
+
+//Instncia nica usada pelos dados por quadro (transformaes, linhas de debug, curvas animadas)
+extern StreamBuffer frameStream;
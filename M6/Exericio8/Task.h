@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+// Tarefa de corrotina (C++20). Comea suspensa: roda quando outra corrotina
+// faz co_await nela (e ento retoma quem esperou ao terminar, na thread em que
+// terminou) ou quando start()  chamado por cdigo que no  corrotina.
+// Em que thread cada trecho roda  decidido pelos awaitables do AssetLoader
+// (Assets::resumeInBackground / Assets::resumeOnMainThread).
+template<typename T>
+class Task;
+
+namespace TaskDetail
+{
+	struct PromiseBase
+	{
+		std::coroutine_handle<> continuation;
+		std::exception_ptr exception;
+		std::atomic<bool> finished{ false };
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			template<typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+			{
+				PromiseBase& promise = handle.promise();
+				std::coroutine_handle<> continuation = promise.continuation;
+				//Depois disso quem chamou start() pode ler o resultado e destruir a tarefa
+				promise.finished.store(true, std::memory_order_release);
+				return continuation ? continuation : std::noop_coroutine();
+			}
+			void await_resume() const noexcept {}
+		};
+
+		std::suspend_always initial_suspend() const noexcept { return {}; }
+		FinalAwaiter final_suspend() const noexcept { return {}; }
+		void unhandled_exception() { exception = std::current_exception(); }
+	};
+
+	template<typename T>
+	struct Promise : PromiseBase
+	{
+		std::optional<T> value;
+
+		Task<T> get_return_object();
+		void return_value(T result) { value = std::move(result); }
+		T take()
+		{
+			if (exception)
+				std::rethrow_exception(exception);
+			return std::move(*value);
+		}
+	};
+
+	template<>
+	struct Promise<void> : PromiseBase
+	{
+		Task<void> get_return_object();
+		void return_void() {}
+		void take()
+		{
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+	};
+}
+
+template<typename T = void>
+class Task
+{
+public:
+	typedef TaskDetail::Promise<T> promise_type;
+
+	Task() : handle(nullptr) {}
+	explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+	Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (handle)
+				handle.destroy();
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	//S pode ser destruda antes de comear ou depois de terminar
+	~Task()
+	{
+		if (handle)
+			handle.destroy();
+	}
+
+	//Comea a tarefa na thread atual (para quem no  corrotina); acompanhar com isDone()
+	void start() { handle.resume(); }
+	bool isDone() const { return handle && handle.promise().finished.load(std::memory_order_acquire); }
+	//Resultado de uma tarefa terminada (relana a exceo, se houve)
+	T result() { return handle.promise().take(); }
+
+	//co_await tarefa: comea a tarefa e retoma quem esperou quando ela termina
+	bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		handle.promise().continuation = awaiting;
+		return handle;
+	}
+	T await_resume() { return handle.promise().take(); }
+
+private:
+	std::coroutine_handle<promise_type> handle;
+};
+
+namespace TaskDetail
+{
+	template<typename T>
+	Task<T> Promise<T>::get_return_object() { return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this)); }
+
+	inline Task<void> Promise<void>::get_return_object() { return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this)); }
+}
@@ -0,0 +1,169 @@
+#include "TransformBatch.h"
+#include "JobSystem.h"
+
+// GLFW
+#include <GLFW/glfw3.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRANSFORM_BATCH_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_BATCH_SSE
+#endif
+
+void TransformBatch::resize(int n)
+{
+	int padded = (n + LANES - 1) / LANES * LANES;
+	//Os objetos de preenchimento ficam com a identidade; as matrizes deles no so expostas
+	positionX.resize(padded, 0.0f);
+	positionY.resize(padded, 0.0f);
+	positionZ.resize(padded, 0.0f);
+	rotationX.resize(padded, 0.0f);
+	rotationY.resize(padded, 0.0f);
+	rotationZ.resize(padded, 0.0f);
+	rotationW.resize(padded, 1.0f);
+	scaleX.resize(padded, 1.0f);
+	scaleY.resize(padded, 1.0f);
+	scaleZ.resize(padded, 1.0f);
+	matrices.resize(padded, glm::mat4(1));
+}
+
+int TransformBatch::add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	resize(count + 1);
+	set(count, position, rotation, scale);
+	return count++;
+}
+
+void TransformBatch::set(int id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	setPosition(id, position);
+	setRotation(id, rotation);
+	scaleX[id] = scale.x;
+	scaleY[id] = scale.y;
+	scaleZ[id] = scale.z;
+}
+
+void TransformBatch::setPosition(int id, const glm::vec3& position)
+{
+	positionX[id] = position.x;
+	positionY[id] = position.y;
+	positionZ[id] = position.z;
+}
+
+void TransformBatch::setRotation(int id, const glm::quat& rotation)
+{
+	rotationX[id] = rotation.x;
+	rotationY[id] = rotation.y;
+	rotationZ[id] = rotation.z;
+	rotationW[id] = rotation.w;
+}
+
+void TransformBatch::clear()
+{
+	count = 0;
+	resize(0);
+}
+
+void TransformBatch::compose(bool parallel)
+{
+	double start = glfwGetTime();
+
+	//Blocos de LANES objetos; cada job escreve s nas matrizes dos seus
+	int blocks = (int)matrices.size() / LANES;
+	if (parallel)
+		jobSystem.parallelFor(blocks, MIN_BLOCKS_PER_JOB, [this](int begin, int end) { composeRange(begin * LANES, end * LANES); });
+	else
+		composeRange(0, blocks * LANES);
+
+	previous = TransformBatchStats{ (unsigned int)count, glfwGetTime() - start };
+}
+
+// Cada coluna da matriz sai de 4 registradores com um elemento da coluna para cada objeto;
+// a transposio 4x4 (feita em cada metade de 128 bits no AVX) deixa a coluna de cada objeto
+// inteira em um registrador.
+#if defined(TRANSFORM_BATCH_AVX)
+#define TRANSFORM_BATCH_TRANSPOSE(r0, r1, r2, r3) \
+	{ \
+		__m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1); \
+		__m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3); \
+		r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)); \
+		r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)); \
+		r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)); \
+		r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)); \
+	}
+#endif
+
+void TransformBatch::composeRange(int begin, int end)
+{
+	//Mesma matriz de glm::mat4_cast, com a escala em cada coluna e a posio na ltima
+#if defined(TRANSFORM_BATCH_AVX)
+	const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+	for (int i = begin; i < end; i += LANES)
+	{
+		__m256 x = _mm256_loadu_ps(&rotationX[i]), y = _mm256_loadu_ps(&rotationY[i]);
+		__m256 z = _mm256_loadu_ps(&rotationZ[i]), w = _mm256_loadu_ps(&rotationW[i]);
+		__m256 sx = _mm256_loadu_ps(&scaleX[i]), sy = _mm256_loadu_ps(&scaleY[i]), sz = _mm256_loadu_ps(&scaleZ[i]);
+		__m256 x2 = _mm256_mul_ps(x, two), y2 = _mm256_mul_ps(y, two), z2 = _mm256_mul_ps(z, two);
+		__m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+		__m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+		__m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+		__m256 c[4][4] = {
+			{ _mm256_mul_ps(sx, _mm256_sub_ps(one, _mm256_add_ps(yy, zz))), _mm256_mul_ps(sx, _mm256_add_ps(xy, wz)), _mm256_mul_ps(sx, _mm256_sub_ps(xz, wy)), zero },
+			{ _mm256_mul_ps(sy, _mm256_sub_ps(xy, wz)), _mm256_mul_ps(sy, _mm256_sub_ps(one, _mm256_add_ps(xx, zz))), _mm256_mul_ps(sy, _mm256_add_ps(yz, wx)), zero },
+			{ _mm256_mul_ps(sz, _mm256_add_ps(xz, wy)), _mm256_mul_ps(sz, _mm256_sub_ps(yz, wx)), _mm256_mul_ps(sz, _mm256_sub_ps(one, _mm256_add_ps(xx, yy))), zero },
+			{ _mm256_loadu_ps(&positionX[i]), _mm256_loadu_ps(&positionY[i]), _mm256_loadu_ps(&positionZ[i]), one } };
+
+		for (int column = 0; column < 4; column++)
+		{
+			TRANSFORM_BATCH_TRANSPOSE(c[column][0], c[column][1], c[column][2], c[column][3]);
+			for (int l = 0; l < 4; l++)
+			{
+				_mm_storeu_ps(&matrices[i + l][column][0], _mm256_castps256_ps128(c[column][l]));
+				_mm_storeu_ps(&matrices[i + 4 + l][column][0], _mm256_extractf128_ps(c[column][l], 1));
+			}
+		}
+	}
+#elif defined(TRANSFORM_BATCH_SSE)
+	const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+	for (int i = begin; i < end; i += LANES)
+	{
+		//Duas metades de 4 objetos por iterao
+		for (int h = i; h < i + LANES; h += 4)
+		{
+			__m128 x = _mm_loadu_ps(&rotationX[h]), y = _mm_loadu_ps(&rotationY[h]);
+			__m128 z = _mm_loadu_ps(&rotationZ[h]), w = _mm_loadu_ps(&rotationW[h]);
+			__m128 sx = _mm_loadu_ps(&scaleX[h]), sy = _mm_loadu_ps(&scaleY[h]), sz = _mm_loadu_ps(&scaleZ[h]);
+			__m128 x2 = _mm_mul_ps(x, two), y2 = _mm_mul_ps(y, two), z2 = _mm_mul_ps(z, two);
+			__m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+			__m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+			__m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+			__m128 c[4][4] = {
+				{ _mm_mul_ps(sx, _mm_sub_ps(one, _mm_add_ps(yy, zz))), _mm_mul_ps(sx, _mm_add_ps(xy, wz)), _mm_mul_ps(sx, _mm_sub_ps(xz, wy)), zero },
+				{ _mm_mul_ps(sy, _mm_sub_ps(xy, wz)), _mm_mul_ps(sy, _mm_sub_ps(one, _mm_add_ps(xx, zz))), _mm_mul_ps(sy, _mm_add_ps(yz, wx)), zero },
+				{ _mm_mul_ps(sz, _mm_add_ps(xz, wy)), _mm_mul_ps(sz, _mm_sub_ps(yz, wx)), _mm_mul_ps(sz, _mm_sub_ps(one, _mm_add_ps(xx, yy))), zero },
+				{ _mm_loadu_ps(&positionX[h]), _mm_loadu_ps(&positionY[h]), _mm_loadu_ps(&positionZ[h]), one } };
+
+			for (int column = 0; column < 4; column++)
+			{
+				_MM_TRANSPOSE4_PS(c[column][0], c[column][1], c[column][2], c[column][3]);
+				for (int l = 0; l < 4; l++)
+					_mm_storeu_ps(&matrices[h + l][column][0], c[column][l]);
+			}
+		}
+	}
+#else
+	for (int i = begin; i < end; i++)
+	{
+		glm::mat4 model = glm::mat4_cast(glm::quat(rotationW[i], rotationX[i], rotationY[i], rotationZ[i]));
+		model[0] *= scaleX[i];
+		model[1] *= scaleY[i];
+		model[2] *= scaleZ[i];
+		model[3] = glm::vec4(positionX[i], positionY[i], positionZ[i], 1.0f);
+		matrices[i] = model;
+	}
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+//GLM
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+struct TransformBatchStats
+{
+	unsigned int objects;
+	double time; //segundos
+};
+
+// Transformaes de muitos objetos (posio, rotao em quatrnio unitrio, escala)
+// em arrays separados por componente (SoA), compostas em lote: cada iterao monta as
+// matrizes de 8 objetos, com AVX quando o compilador gera AVX, duas vezes 4 com SSE
+// caso contrrio (e um lao escalar fora do x86). O quatrnio evita o seno/cosseno do
+// glm::rotate. As matrizes saem contguas, no formato das instncias do InstancedMesh.
+// Com muitos objetos, os blocos so divididos entre as threads do JobSystem.
+class TransformBatch
+{
+public:
+	static const int LANES = 8;
+
+	TransformBatch() : count(0), previous{} {}
+
+	//Retorna o identificador do objeto (ndice nos arrays e na sada)
+	int add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	void set(int id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	void setPosition(int id, const glm::vec3& position);
+	void setRotation(int id, const glm::quat& rotation);
+	void clear();
+	int getCount() const { return count; }
+
+	//parallel = false: s na thread atual (para comparar no benchmark)
+	void compose(bool parallel = true);
+	//getCount() matrizes model, vlidas depois do compose()
+	const glm::mat4* getMatrices() const { return matrices.data(); }
+
+	const TransformBatchStats& lastFrame() const { return previous; }
+
+protected:
+	//Menos blocos que isso por job no compensa o envio
+	static const int MIN_BLOCKS_PER_JOB = 256;
+
+	void resize(int n);
+	void composeRange(int begin, int end);
+
+	int count;
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+	std::vector<glm::mat4> matrices;
+
+	TransformBatchStats previous;
+};
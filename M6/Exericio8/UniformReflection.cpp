@@ -0,0 +1,110 @@
+#include "UniformReflection.h"
+
+#include <algorithm>
+#include <cstring>
+
+void reflectProgram(GLuint program, std::vector<UniformInfo>& uniforms, std::vector<UniformBlockInfo>& blocks)
+{
+	uniforms.clear();
+	blocks.clear();
+
+	GLint nUniforms = 0, maxLength = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &nUniforms);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::vector<GLchar> name(maxLength > 0 ? maxLength : 1);
+	for (GLuint i = 0; i < (GLuint)nUniforms; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(program, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+		//Membros de uniform blocks no tm location prpria
+		GLint blockIndex = -1;
+		glGetActiveUniformsiv(program, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+		if (blockIndex != -1 || strncmp(name.data(), "gl_", 3) == 0)
+			continue;
+
+		//Arrays aparecem como "nome[0]" - o hash usa s o nome base
+		if (length > 3 && strcmp(name.data() + length - 3, "[0]") == 0)
+			length -= 3;
+
+		UniformInfo info;
+		info.hash = hashUniformNameN(name.data(), (int)length);
+		info.name.assign(name.data(), length);
+		info.location = glGetUniformLocation(program, info.name.c_str());
+		info.type = type;
+		info.size = size;
+		uniforms.push_back(info);
+	}
+
+	GLint nBlocks = 0;
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &nBlocks);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+	name.resize(maxLength > 0 ? maxLength : 1);
+	for (GLuint i = 0; i < (GLuint)nBlocks; i++)
+	{
+		GLsizei length = 0;
+		glGetActiveUniformBlockName(program, i, (GLsizei)name.size(), &length, name.data());
+
+		UniformBlockInfo info;
+		info.hash = hashUniformNameN(name.data(), (int)length);
+		info.name.assign(name.data(), length);
+		info.index = i;
+		glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &info.dataSize);
+		blocks.push_back(info);
+	}
+
+	std::sort(uniforms.begin(), uniforms.end(), [](const UniformInfo& a, const UniformInfo& b) { return a.hash < b.hash; });
+	std::sort(blocks.begin(), blocks.end(), [](const UniformBlockInfo& a, const UniformBlockInfo& b) { return a.hash < b.hash; });
+
+	for (size_t i = 1; i < uniforms.size(); i++)
+	{
+		if (uniforms[i].hash == uniforms[i - 1].hash)
+			std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION " << uniforms[i - 1].name << " / " << uniforms[i].name << std::endl;
+	}
+}
+
+bool validateProgram(const char* label, const std::vector<UniformInfo>& uniforms, const std::vector<UniformBlockInfo>& blocks,
+	const UniformSignature* declared, int nDeclared, const UniformBlockDecl* declaredBlocks, int nDeclaredBlocks)
+{
+	bool ok = true;
+	std::vector<bool> matched(uniforms.size(), false);
+
+	for (int i = 0; i < nDeclared; i++)
+	{
+		const UniformInfo* info = findUniform(uniforms, declared[i].hash);
+		if (!info)
+		{
+			std::cout << "WARNING::SHADER::" << label << "::UNIFORM_NOT_ACTIVE " << declared[i].name << std::endl;
+			ok = false;
+			continue;
+		}
+		matched[info - uniforms.data()] = true;
+		if (!uniformTypeCompatible(declared[i].type, info->type))
+		{
+			std::cout << "ERROR::SHADER::" << label << "::UNIFORM_TYPE_MISMATCH " << declared[i].name
+				<< " (C++ 0x" << std::hex << declared[i].type << ", GLSL 0x" << info->type << std::dec << ")" << std::endl;
+			ok = false;
+		}
+	}
+
+	//Uniforms do shader que o C++ nunca declarou ficam com o valor padro
+	for (size_t i = 0; i < uniforms.size(); i++)
+	{
+		if (!matched[i])
+			std::cout << "WARNING::SHADER::" << label << "::UNIFORM_NOT_DECLARED " << uniforms[i].name << std::endl;
+	}
+
+	for (int i = 0; i < nDeclaredBlocks; i++)
+	{
+		if (!findUniformBlock(blocks, declaredBlocks[i].hash))
+		{
+			std::cout << "WARNING::SHADER::" << label << "::UNIFORM_BLOCK_NOT_ACTIVE " << declaredBlocks[i].name << std::endl;
+			ok = false;
+		}
+	}
+
+	return ok;
+}
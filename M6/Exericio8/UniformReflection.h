@@ -0,0 +1,137 @@
+// Reflexo de uniforms: nomes com hash calculado em tempo de compilao,
+// declaraes tipadas no C++ e validao contra o programa linkado
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+//GLAD
+#include <glad/glad.h>
+#include "GLExtensions.h"
+
+//GLM
+#include <glm/glm.hpp>
+
+// Hash FNV-1a de 32 bits, avaliado em tempo de compilao para nomes literais
+constexpr uint32_t hashUniformName(const char* name, uint32_t hash = 2166136261u)
+{
+	return *name == '\0' ? hash : hashUniformName(name + 1, (hash ^ (uint32_t)(unsigned char)*name) * 16777619u);
+}
+
+// Mesmo hash, mas limitado a n caracteres (usado para remover o sufixo "[0]" de arrays)
+inline uint32_t hashUniformNameN(const char* name, int n)
+{
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < n; i++)
+		hash = (hash ^ (uint32_t)(unsigned char)name[i]) * 16777619u;
+	return hash;
+}
+
+// Tipo GLSL esperado para cada tipo C++ aceito pelos setters
+template <typename T> struct UniformGLType;
+template <> struct UniformGLType<bool> { static constexpr GLenum value = GL_BOOL; };
+template <> struct UniformGLType<int> { static constexpr GLenum value = GL_INT; };
+template <> struct UniformGLType<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct UniformGLType<glm::vec2> { static constexpr GLenum value = GL_FLOAT_VEC2; };
+template <> struct UniformGLType<glm::vec3> { static constexpr GLenum value = GL_FLOAT_VEC3; };
+template <> struct UniformGLType<glm::vec4> { static constexpr GLenum value = GL_FLOAT_VEC4; };
+template <> struct UniformGLType<glm::ivec3> { static constexpr GLenum value = GL_INT_VEC3; };
+template <> struct UniformGLType<glm::mat4> { static constexpr GLenum value = GL_FLOAT_MAT4; };
+
+// Assinatura sem tipo C++ de um uniform declarado (nome, hash e tipo GLSL)
+struct UniformSignature
+{
+	const char* name;
+	uint32_t hash;
+	GLenum type;
+};
+
+// Declarao tipada de um uniform - ex.: constexpr UniformDecl<glm::mat4> model("model");
+template <typename T>
+struct UniformDecl : UniformSignature
+{
+	constexpr explicit UniformDecl(const char* name) : UniformSignature{ name, hashUniformName(name), UniformGLType<T>::value } {}
+};
+
+// Declarao de um uniform block
+struct UniformBlockDecl
+{
+	const char* name;
+	uint32_t hash;
+	constexpr explicit UniformBlockDecl(const char* name) : name(name), hash(hashUniformName(name)) {}
+};
+
+// Uniform ativo lido do programa depois do link
+struct UniformInfo
+{
+	uint32_t hash;
+	GLint location;
+	GLenum type;
+	GLint size;
+	std::string name;
+};
+
+// Uniform block ativo lido do programa depois do link
+struct UniformBlockInfo
+{
+	uint32_t hash;
+	GLuint index;
+	GLint dataSize;
+	std::string name;
+};
+
+// Samplers so atribudos com glUniform1i, ento um setter int serve para eles
+inline bool uniformTypeCompatible(GLenum declared, GLenum active)
+{
+	if (declared == active)
+		return true;
+	if (declared == GL_INT)
+		return active == GL_BOOL || active == GL_SAMPLER_2D || active == GL_SAMPLER_3D || active == GL_SAMPLER_CUBE || active == GL_SAMPLER_2D_ARRAY
+			|| active == GL_IMAGE_2D;
+	return false;
+}
+
+// L os uniforms (fora de blocks) e os uniform blocks ativos do programa.
+// Os vetores de sada ficam ordenados por hash para a busca binria dos setters.
+void reflectProgram(GLuint program, std::vector<UniformInfo>& uniforms, std::vector<UniformBlockInfo>& blocks);
+
+// Compara o que o programa expe com o que o C++ declara e imprime as diferenas.
+// Retorna false se algum uniform declarado estiver ausente ou com tipo diferente.
+bool validateProgram(const char* label, const std::vector<UniformInfo>& uniforms, const std::vector<UniformBlockInfo>& blocks,
+	const UniformSignature* declared, int nDeclared, const UniformBlockDecl* declaredBlocks = nullptr, int nDeclaredBlocks = 0);
+
+// Busca binria por hash - no aloca nada
+inline const UniformInfo* findUniform(const std::vector<UniformInfo>& uniforms, uint32_t hash)
+{
+	int lo = 0, hi = (int)uniforms.size() - 1;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (uniforms[mid].hash == hash)
+			return &uniforms[mid];
+		if (uniforms[mid].hash < hash)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return nullptr;
+}
+
+inline const UniformBlockInfo* findUniformBlock(const std::vector<UniformBlockInfo>& blocks, uint32_t hash)
+{
+	int lo = 0, hi = (int)blocks.size() - 1;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (blocks[mid].hash == hash)
+			return &blocks[mid];
+		if (blocks[mid].hash < hash)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return nullptr;
+}
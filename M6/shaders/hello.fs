@@ -24,8 +24,75 @@ out vec4 color;
 //buffer de textura
 uniform sampler2D colorBuffer;
 
+//Pr-passagem de profundidade: s a profundidade interessa, a cor  descartada (glColorMask)
+uniform bool depthOnly;
+
+//Luzes pontuais agrupadas por cluster (ClusteredLighting / light_cluster.comp)
+struct PointLight
+{
+    vec4 positionRadius;
+    vec4 color;
+};
+
+layout (std430, binding = 5) readonly buffer Lights
+{
+    PointLight lights[];
+};
+
+layout (std430, binding = 6) readonly buffer ClusterCounts
+{
+    uint clusterCounts[];
+};
+
+layout (std430, binding = 7) readonly buffer ClusterLights
+{
+    uint clusterLights[];
+};
+
+uniform bool clusteredLights;
+uniform mat4 view;
+uniform ivec3 clusterGrid;
+uniform vec2 clusterScreenSize;
+uniform vec2 clusterDepthRange;
+uniform int maxLightsPerCluster;
+
+//Soma das luzes pontuais do cluster do fragmento (s elas, no todas as da cena)
+vec3 pointLights(vec3 N, vec3 V, vec3 albedo)
+{
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+    int slice = int(log(viewDepth / clusterDepthRange.x) / log(clusterDepthRange.y / clusterDepthRange.x) * float(clusterGrid.z));
+    ivec2 tile = ivec2(gl_FragCoord.xy / clusterScreenSize * vec2(clusterGrid.xy));
+    ivec3 c = clamp(ivec3(tile, slice), ivec3(0), clusterGrid - 1);
+    int cluster = c.x + clusterGrid.x * (c.y + clusterGrid.y * c.z);
+
+    vec3 result = vec3(0.0);
+    uint count = clusterCounts[cluster];
+    for (uint i = 0; i < count; i++)
+    {
+        PointLight light = lights[clusterLights[cluster * maxLightsPerCluster + int(i)]];
+        vec3 toLight = light.positionRadius.xyz - fragPos;
+        float distance = length(toLight);
+        if (distance >= light.positionRadius.w)
+            continue;
+        //Atenuao que chega a zero no alcance da luz (sem corte visvel na borda do cluster)
+        float falloff = 1.0 - (distance * distance) / (light.positionRadius.w * light.positionRadius.w);
+        float attenuation = falloff * falloff;
+        vec3 L = toLight / distance;
+        float diff = max(dot(N, L), 0.0);
+        float spec = pow(max(dot(reflect(-L, N), V), 0.0), q);
+        result += attenuation * light.color.rgb * (diff * kd * albedo + spec * ks);
+    }
+    return result;
+}
+
 void main()
 {
+    if (depthOnly)
+    {
+        color = vec4(0.0);
+        return;
+    }
+
     // Ambient
     vec3 ambient =  lightColor * ka;
     // Diffuse 
@@ -42,6 +109,8 @@ void main()
     
     vec4 texColor = texture(colorBuffer,texCoord);
     vec3 result = (ambient + diffuse) * vec3(texColor) + specular;
+    if (clusteredLights)
+        result += pointLights(N, V, vec3(texColor));
 
     color = vec4(result, 1.0f);
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texc;
 layout (location = 2) in vec3 normal;
+//Matriz model de cada instncia (InstancedMesh); nas malhas comuns vale a identidade
+layout (location = 3) in mat4 instanceModel;
 
 out vec3 finalColor;
 out vec3 fragPos;
@@ -10,13 +12,26 @@ out vec2 texCoord;
 out vec3 scaledNormal;
 
 uniform mat4 projection;
-uniform mat4 model;
 uniform mat4 view;
 
+//Transformao do objeto, escrita pela CPU no buffer de streaming do quadro
+layout (std140, binding = 0) uniform ObjectData
+{
+	mat4 model;
+};
+
+//Matrizes dos objetos desenhados pelo DrawBatcher (uma por comando do glMultiDrawElementsIndirect)
+layout (std430, binding = 1) readonly buffer DrawData
+{
+	mat4 drawModels[];
+};
+uniform bool multiDraw;
+
 void main()
 {
-	gl_Position = projection * view  * model * vec4(position, 1.0);
-	fragPos = vec3(model * vec4(position, 1.0));
+	mat4 world = (multiDraw ? drawModels[gl_DrawID] : model) * instanceModel;
+	gl_Position = projection * view  * world * vec4(position, 1.0);
+	fragPos = vec3(world * vec4(position, 1.0));
 	texCoord = vec2(texc.x, 1-texc.y);
 	scaledNormal = normal;
 }
\ No newline at end of file